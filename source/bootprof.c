@@ -0,0 +1,92 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include "bios.h"
+#include "bootprof.h"
+#include "main.h"
+#include "text.h"
+
+// Timestamps of the current boot, read from the cycle counter started
+// by bootStart(). The previous boot is kept for the breakdown screen.
+uint32_t aBootTimes[BOOT_PHASES];
+int nBootPhase;
+
+static uint32_t aLastBootTimes[BOOT_PHASES] EWRAM_BSS;
+static int nLastBootPhase EWRAM_BSS;
+
+static const char aBootPhasesNames[BOOT_PHASES][19] = {
+	"irqInit",
+	"consoleSetup",
+	"Release buttons",
+	"Options menu",
+	"Timing menu",
+	"Profile menu",
+	"Rumble detection",
+	"Profile tables",
+	"RegisterRamReset",
+	"Controller screen",
+	"SI setup",
+	"First reply",
+};
+
+void bootStart(void)
+{
+	for (int i = 0; i < BOOT_PHASES; i++) {
+		aLastBootTimes[i] = aBootTimes[i];
+	}
+	nLastBootPhase = nBootPhase;
+	nBootPhase = 0;
+	clockStart(0);
+}
+
+// Cycles to hundredths of milliseconds
+static int bootCentiMs(uint32_t cycles)
+{
+	return ((uint64_t)cycles * 100000) >> 24;
+}
+
+bool showBootTimes(void)
+{
+	textClear();
+	textPuts("==== Last boot times (ms) ===\n");
+	uint32_t previous = 0;
+	for (int i = 0; i < BOOT_PHASES; i++) {
+		textPuts("\n");
+		textPuts(aBootPhasesNames[i]);
+		textMoveTo(2 + i, 20);
+		if (i < nLastBootPhase) {
+			textPutFixed(bootCentiMs(aLastBootTimes[i] - previous), 2);
+			previous = aLastBootTimes[i];
+		} else {
+			textPuts("-");
+		}
+	}
+	textPuts("\n\nTotal");
+	textMoveTo(2 + BOOT_PHASES + 1, 20);
+	textPutFixed(bootCentiMs(previous), 2);
+	return statsPageWait();
+}
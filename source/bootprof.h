@@ -0,0 +1,63 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BOOTPROF_H
+#define BOOTPROF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "clock.h"
+
+// Startup phases, each timestamped when it ends
+enum {
+	BOOT_IRQ_INIT = 0,
+	BOOT_CONSOLE,
+	BOOT_RELEASE,
+	BOOT_MENU_OPTIONS,
+	BOOT_MENU_TIMING,
+	BOOT_MENU_PROFILE,
+	BOOT_RUMBLE_DETECT,
+	BOOT_TABLES,
+	BOOT_REGISTER_RESET,
+	BOOT_SCREEN,
+	BOOT_SI_SETUP,
+	BOOT_FIRST_REPLY,
+	BOOT_PHASES
+};
+
+extern uint32_t aBootTimes[BOOT_PHASES];
+extern int nBootPhase;
+
+static inline void bootMark(int phase)
+{
+	aBootTimes[phase] = clockRead();
+	nBootPhase = phase + 1;
+}
+
+void bootStart(void);
+bool showBootTimes(void);
+
+#endif /* BOOTPROF_H */
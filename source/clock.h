@@ -0,0 +1,60 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+#include <gba_timers.h>
+
+// Free-running 32-bit cycle counter on timers 2 and 3 (cascaded), wraps
+// every 256 seconds. Timers 0 and 1 belong to SIGetCommand.
+
+#define CLOCK_HZ 16777216
+
+// Start counting from t, the timers load their reload value when started
+static inline void clockStart(uint32_t t)
+{
+	REG_TM2CNT_H = REG_TM3CNT_H = 0;
+	REG_TM2CNT_L = t;
+	REG_TM3CNT_L = t >> 16;
+	REG_TM3CNT_H = TIMER_START | TIMER_COUNT;
+	REG_TM2CNT_H = TIMER_START;
+	REG_TM2CNT_L = 0;
+	REG_TM3CNT_L = 0;
+}
+
+static inline uint32_t clockRead(void)
+{
+	uint16_t hi, lo;
+	do {
+		hi = REG_TM3CNT_L;
+		lo = REG_TM2CNT_L;
+	} while (hi != REG_TM3CNT_L);
+	return (uint32_t)hi << 16 | lo;
+}
+
+#endif /* CLOCK_H */
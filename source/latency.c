@@ -0,0 +1,125 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include "bios.h"
+#include "latency.h"
+#include "main.h"
+#include "text.h"
+
+// Kept across soft resets, SELECT on the histogram page clears it
+uint16_t aLatency[LATENCY_PROFILES][LATENCY_RATES][LATENCY_BINS] EWRAM_BSS;
+uint16_t *pLatencyRow = aLatency[0][0];
+
+// Upper bound of the poll period of each rate class, in cycles
+static const uint32_t aLatencyRates[LATENCY_RATES - 1] = {
+	CLOCK_HZ / 400,
+	CLOCK_HZ / 200,
+	CLOCK_HZ / 100,
+};
+
+static const char aLatencyRatesNames[LATENCY_RATES][12] = {
+	"> 400 Hz",
+	"200-400 Hz",
+	"100-200 Hz",
+	"< 100 Hz",
+};
+
+// Called at profile load and whenever the measured poll rate changes
+void latencySelect(int nGameProfile, uint32_t nPollCycles)
+{
+	int nRate = 0;
+	while (nRate < LATENCY_RATES - 1 && nPollCycles > aLatencyRates[nRate]) {
+		nRate++;
+	}
+	pLatencyRow = aLatency[nGameProfile][nRate];
+}
+
+static void printLatency(int nGameProfile, int nRate)
+{
+	const uint16_t *row = aLatency[nGameProfile][nRate];
+	unsigned nMax = 1;
+	for (int i = 0; i < LATENCY_BINS; i++) {
+		if (row[i] > nMax) {
+			nMax = row[i];
+		}
+	}
+	textClear();
+	textPuts("Latency, ");
+	textPuts(aLatencyRatesNames[nRate]);
+	textPuts("\n");
+	textPuts(gameProfileName(nGameProfile));
+	for (int i = 0; i < LATENCY_BINS; i++) {
+		textMoveTo(2 + i, 0);
+		textPutInt(i);
+		textPuts(i < LATENCY_BINS - 1 ? " ms" : "+ms");
+		// Bars of up to 16 characters
+		textMoveTo(2 + i, 6);
+		for (int n = Div(row[i] * 16 + nMax - 1, nMax).quot; n > 0; n--) {
+			textPuts("#");
+		}
+		textMoveTo(2 + i, 23);
+		textPutInt(row[i]);
+	}
+	textMoveTo(TEXT_ROWS - 2, 0);
+	textPuts("D-pad: Select  SELECT: Clear");
+	textPuts("\nA: Next   B: Back");
+}
+
+bool showLatency(void)
+{
+	int nGameProfile = 0;
+	int nRate = 0;
+	printLatency(nGameProfile, nRate);
+	inputReleasedWait();
+	for (;;) {
+		VBlankIntrWait();
+		bool refreshed = true;
+		unsigned buttons = ~REG_KEYINPUT;
+		if ((buttons & KEY_A) || (buttons & KEY_B)) {
+			inputReleasedWait();
+			return buttons & KEY_A;
+		} else if (buttons & KEY_SELECT) {
+			for (int i = 0; i < LATENCY_BINS; i++) {
+				aLatency[nGameProfile][nRate][i] = 0;
+			}
+		} else if (buttons & KEY_RIGHT) {
+			nGameProfile = (nGameProfile + 1) % LATENCY_PROFILES;
+		} else if (buttons & KEY_LEFT) {
+			nGameProfile = (nGameProfile + LATENCY_PROFILES - 1) % LATENCY_PROFILES;
+		} else if (buttons & KEY_DOWN) {
+			nRate = (nRate + 1) % LATENCY_RATES;
+		} else if (buttons & KEY_UP) {
+			nRate = (nRate + LATENCY_RATES - 1) % LATENCY_RATES;
+		} else {
+			refreshed = false;
+		}
+		if (refreshed) {
+			printLatency(nGameProfile, nRate);
+			inputReleasedWait();
+		}
+	}
+}
@@ -0,0 +1,57 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "clock.h"
+
+// Time from a key press, stamped when the keypad interrupt wakes the
+// receiver, to the end of the first reply carrying it. Counted in 1 ms
+// bins, the last one open, per game profile and poll rate class.
+
+#define LATENCY_BINS     16
+#define LATENCY_RATES    4
+#define LATENCY_PROFILES 7
+
+extern uint16_t aLatency[LATENCY_PROFILES][LATENCY_RATES][LATENCY_BINS];
+extern uint16_t *pLatencyRow;
+
+static inline void latencyRecord(uint32_t cycles)
+{
+	unsigned ms = ((uint64_t)cycles * 1000) >> 24;
+	if (ms >= LATENCY_BINS)
+		ms = LATENCY_BINS - 1;
+	if (pLatencyRow[ms] < UINT16_MAX)
+		pLatencyRow[ms]++;
+}
+
+void latencySelect(int nGameProfile, uint32_t nPollCycles);
+bool showLatency(void);
+
+#endif /* LATENCY_H */
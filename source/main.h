@@ -0,0 +1,166 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAIN_H
+#define MAIN_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <gba_input.h>
+
+// Shared between the Joybus loop in main.iwram.c (IWRAM) and the setup
+// screens in menu.c (EWRAM).
+
+#define ROM           ((int16_t *)0x08000000)
+#define ROM_GPIODATA *((volatile int16_t *)0x080000C4)
+#define ROM_GPIODIR  *((volatile int16_t *)0x080000C6)
+#define ROM_GPIOCNT  *((volatile int16_t *)0x080000C8)
+
+enum {
+	ID_GBAKEY_A = 0,
+	ID_GBAKEY_B = 1,
+	ID_GBAKEY_START = 2,
+	ID_GBAKEY_SELECT = 3,
+	ID_GBAKEY_L = 4,
+	ID_GBAKEY_R = 5,
+	ID_GBAKEY_UP = 6,
+	ID_GBAKEY_DOWN = 7,
+	ID_GBAKEY_LEFT = 8,
+	ID_GBAKEY_RIGHT = 9,
+};
+
+enum {
+	ID_GCPAD_A = 0,
+	ID_GCPAD_B = 1,
+	ID_GCPAD_X = 2,
+	ID_GCPAD_Y = 3,
+	ID_GCPAD_START = 4,
+	ID_GCPAD_Z = 5,
+	ID_GCPAD_L = 6,
+	ID_GCPAD_R = 7,
+	ID_GCPAD_UP = 8,
+	ID_GCPAD_DOWN = 9,
+	ID_GCPAD_LEFT = 10,
+	ID_GCPAD_RIGHT = 11,
+	ID_GCPAD_WALK = 12,
+	ID_GCPAD_TURBO_A = 13,
+	ID_GCPAD_TURBO_B = 14,
+	ID_GCPAD_MACRO = 15,
+	ID_GCPAD_SHIFT = 16,
+	ID_GCPAD_RECAL = 17, // X+Y+START, shift layer only
+	ID_GCPAD_NONE = 18,  // Shift layer only
+	ID_GCPADS
+};
+
+// Macros the MACRO key of the custom profile can play
+enum {
+	MACRO_SHORT_HOP = 0,
+	MACRO_FULL_HOP,
+	MACRO_DOUBLE_A,
+	MACROS
+};
+
+// Key pairs pressed together in the shift layer, A+B and L+R
+#define SHIFT_CHORDS 2
+
+// aCustomGameProfileConfig holds the ID_GCPAD_* of the first six GBA keys,
+// the MACRO_* played by its MACRO key, then the ID_GCPAD_* of the same six
+// keys and of the chords while its SHIFT key is held
+enum {
+	CUSTOM_MACRO = 6,
+	CUSTOM_SHIFT,
+	CUSTOM_CHORDS = CUSTOM_SHIFT + 6,
+	CUSTOM_CONFIG = CUSTOM_CHORDS + SHIFT_CHORDS
+};
+
+enum {
+	RUMBLE_NONE = 0,
+	RUMBLE_GBA,
+	RUMBLE_NDS,
+	RUMBLE_NDS_SLIDE,
+	RUMBLE_EZFLASH_OMEGA_DE,
+};
+
+// Settings of the options screen, kept across soft resets
+enum {
+	OPTION_PRINT_KEYS = 0,
+	OPTION_DISPLAY_OFF,
+	OPTION_SLEEP,
+	OPTION_TURBO_RATE,
+	OPTION_REPLAY,
+	OPTION_SENSOR,
+	OPTION_LATCH,
+	OPTION_LATENCY,
+	OPTION_RECEIVER,
+	OPTION_PERSONALITY,
+	OPTION_CONSOLE,
+	OPTIONS
+};
+
+// Held together while the display is off to turn it back on
+#define KEYS_DISPLAY_WAKE (KEY_L | KEY_R | KEY_SELECT)
+
+// Stick driven by a tilt or gyro cartridge
+enum {
+	SENSOR_STICK_OFF = 0,
+	SENSOR_STICK_MAIN,
+	SENSOR_STICK_C
+};
+
+// Protocol answered on the link port
+enum {
+	CONSOLE_GC = 0,
+	CONSOLE_N64
+};
+
+// Controller reported to the console, see aPersonalities
+enum {
+	PERSONALITY_AUTO = 0, // Standard pad, without rumble when none is found
+	PERSONALITY_PAD,
+	PERSONALITY_NO_RUMBLE,
+	PERSONALITY_WAVEBIRD,
+	PERSONALITY_CUSTOM,
+	PERSONALITIES
+};
+
+extern int aOptions[OPTIONS];
+extern int rumble;
+extern bool hasMotor;
+extern int aCustomGameProfileConfig[CUSTOM_CONFIG];
+
+void consoleSetup(int phase);
+void showHeader(void);
+int getPressedButtonsNumber(void);
+void inputReleasedWait(void);
+bool has_motor(void);
+void configureOptions(void);
+bool statsPageWait(void);
+int timingSelect(void);
+int profileSelect(void);
+const char *gameProfileName(int nGameProfile);
+void showControllerScreen(int nGameProfile);
+
+#endif /* MAIN_H */
@@ -25,9 +25,6 @@
  */
 
 #include <stdint.h>
-#include <stdio.h>
-#include <string.h>
-#include <gba_console.h>
 #include <gba_dma.h>
 #include <gba_input.h>
 #include <gba_interrupt.h>
@@ -35,54 +32,157 @@
 #include <gba_timers.h>
 #include <gba_video.h>
 #include "bios.h"
+#include "bootprof.h"
+#include "latency.h"
+#include "main.h"
+#include "prof.h"
+#include "replay.h"
+#include "sensor.h"
+#include "si.h"
+#include "text.h"
+
+// Command descriptors, declared ahead of the big-endian structs below so
+// that their pointers stay aligned native words
+struct command {
+	void (*handler)(const struct command *cmd);
+	const void *reply;
+	unsigned replyBits;
+};
 
 #define struct struct __attribute__((packed, scalar_storage_order("big-endian")))
 
-#define ROM           ((int16_t *)0x08000000)
-#define ROM_GPIODATA *((int16_t *)0x080000C4)
-#define ROM_GPIODIR  *((int16_t *)0x080000C6)
-#define ROM_GPIOCNT  *((int16_t *)0x080000C8)
 #define GPIO_IRQ	0x0100	//! Interrupt on SI.
 
-enum {
-	ID_GBAKEY_A = 0,
-	ID_GBAKEY_B = 1,
-	ID_GBAKEY_START = 2,
-	ID_GBAKEY_SELECT = 3,
-	ID_GBAKEY_L = 4,
-	ID_GBAKEY_R = 5,
-	ID_GBAKEY_UP = 6,
-	ID_GBAKEY_DOWN = 7,
-	ID_GBAKEY_LEFT = 8,
-	ID_GBAKEY_RIGHT = 9,
+// Station builds, 'make STATION_PROFILE=n': one game profile, host timing,
+// rumble backend and console fixed at compile time. The menus are skipped,
+// the settings marked STATION_CONST become constants and the checks on
+// them fold away. Their initializers are the station values.
+#ifdef STATION_PROFILE
+#ifndef STATION_TIMING
+#define STATION_TIMING 67
+#endif
+#ifndef STATION_RUMBLE
+#define STATION_RUMBLE RUMBLE_NONE
+#endif
+#define STATION_CONST static const
+#define getCommand SIGetCommand
+#define RUMBLE_BACKEND STATION_RUMBLE
+#else
+#define STATION_CONST static
+#define RUMBLE_BACKEND rumble
+#endif
+#ifndef STATION_CONSOLE
+#define STATION_CONSOLE CONSOLE_GC
+#endif
+
+// Everything in this file is linked in IWRAM, except for the profile loading
+// marked EWRAM_CODE. Constant tables only read at profile load stay in EWRAM.
+
+static const unsigned aGbaKeyMasks[10] = {
+	KEY_A, KEY_B, KEY_START, KEY_SELECT, KEY_L, KEY_R,
+	KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT
 };
 
+// Analog response curves, in percent of a full stick tilt
+#define STICK_RANGE    100
+#define STICK_DIAGONAL 71  // Keep diagonals inside the octagonal gate
+#define STICK_WALK     50  // Partial tilt while the walk key is held
+#define ANALOG_PRESS   200 // Fully pressed analog trigger or button
+#define ANALOG_RAMP_MAX 32
+
+// Polls needed to fully press an analog trigger or button, per game profile
+static const int aGameProfilesRamp[7] = {0, 0, 0, 6, 0, 0, 0};
+
+// Digital buttons word as sent on the wire, same bits as libogc
 enum {
-	ID_GCPAD_A = 0,
-	ID_GCPAD_B = 1,
-	ID_GCPAD_X = 2,
-	ID_GCPAD_Y = 3,
-	ID_GCPAD_START = 4,
-	ID_GCPAD_Z = 5,
-	ID_GCPAD_L = 6,
-	ID_GCPAD_R = 7,
-	ID_GCPAD_UP = 8,
-	ID_GCPAD_DOWN = 9,
-	ID_GCPAD_LEFT = 10,
-	ID_GCPAD_RIGHT = 11,
+	PAD_BUTTON_LEFT  = 0x0001,
+	PAD_BUTTON_RIGHT = 0x0002,
+	PAD_BUTTON_DOWN  = 0x0004,
+	PAD_BUTTON_UP    = 0x0008,
+	PAD_TRIGGER_Z    = 0x0010,
+	PAD_TRIGGER_R    = 0x0020,
+	PAD_TRIGGER_L    = 0x0040,
+	PAD_USE_ORIGIN   = 0x0080,
+	PAD_BUTTON_A     = 0x0100,
+	PAD_BUTTON_B     = 0x0200,
+	PAD_BUTTON_X     = 0x0400,
+	PAD_BUTTON_Y     = 0x0800,
+	PAD_BUTTON_START = 0x1000,
+	PAD_GET_ORIGIN   = 0x2000,
 };
 
-static char aGameProfilesNames[7][30] = {
-	"Custom profile",
-	"Default",
-	"Super Smash Ultimate",
-	"Mario Kart Double Dash",
-	"Mario Kart 8 Deluxe",
-	"New Super Mario Bros",
-	"Mario Kart Wii"
+// GameCube buttons pressed by each GBA key, in aGbaKeyMasks order.
+// The custom profile is built from aCustomGameProfileConfig instead.
+static const uint16_t aGameProfilesButtons[7][10] = {
+	[1] = { // Default
+		PAD_BUTTON_A, PAD_BUTTON_B, PAD_BUTTON_START, PAD_TRIGGER_Z, PAD_TRIGGER_L, PAD_TRIGGER_R
+	},
+	[2] = { // Super Smash Ultimate
+		PAD_BUTTON_A, PAD_BUTTON_B, PAD_BUTTON_START, PAD_BUTTON_X, PAD_TRIGGER_L, PAD_TRIGGER_Z
+	},
+	[3] = { // Mario Kart Double Dash
+		PAD_BUTTON_A, PAD_TRIGGER_Z, PAD_BUTTON_START, PAD_BUTTON_B, PAD_BUTTON_X, PAD_TRIGGER_R
+	},
+	[4] = { // Mario Kart 8 Deluxe
+		PAD_BUTTON_A, PAD_BUTTON_B, PAD_BUTTON_START, PAD_BUTTON_X, PAD_TRIGGER_L, PAD_TRIGGER_R
+	},
+	[5] = { // New Super Mario Bros
+		PAD_BUTTON_A, PAD_BUTTON_Y, PAD_BUTTON_START, PAD_BUTTON_B, PAD_TRIGGER_L, PAD_TRIGGER_R
+	},
+	[6] = { // Mario Kart Wii
+		PAD_BUTTON_A, PAD_BUTTON_X, PAD_BUTTON_START, 0, PAD_TRIGGER_L, PAD_BUTTON_B,
+		PAD_BUTTON_UP, PAD_BUTTON_DOWN
+	},
+};
+
+// Indexed by ID_GCPAD_*, the pseudo buttons press nothing by themselves
+static const uint16_t aGcPadMasks[ID_GCPADS] = {
+	PAD_BUTTON_A, PAD_BUTTON_B, PAD_BUTTON_X, PAD_BUTTON_Y, PAD_BUTTON_START,
+	PAD_TRIGGER_Z, PAD_TRIGGER_L, PAD_TRIGGER_R,
+	PAD_BUTTON_UP, PAD_BUTTON_DOWN, PAD_BUTTON_LEFT, PAD_BUTTON_RIGHT,
+	0, PAD_BUTTON_A, PAD_BUTTON_B, 0, 0,
+	PAD_BUTTON_X | PAD_BUTTON_Y | PAD_BUTTON_START, 0
+};
+
+// Stick directions carried above the buttons in aButtonsMap, each in the
+// RIGHT, LEFT, UP, DOWN order of the stick tables, plus the walk key
+#define MAP_STICK_SHIFT  16
+#define MAP_CSTICK_SHIFT 21
+
+enum {
+	MAP_STICK_RIGHT  = 0x01 << MAP_STICK_SHIFT,
+	MAP_STICK_LEFT   = 0x02 << MAP_STICK_SHIFT,
+	MAP_STICK_UP     = 0x04 << MAP_STICK_SHIFT,
+	MAP_STICK_DOWN   = 0x08 << MAP_STICK_SHIFT,
+	MAP_STICK_WALK   = 0x10 << MAP_STICK_SHIFT,
+	MAP_CSTICK_RIGHT = 0x01 << MAP_CSTICK_SHIFT,
+	MAP_CSTICK_LEFT  = 0x02 << MAP_CSTICK_SHIFT,
+	MAP_CSTICK_UP    = 0x04 << MAP_CSTICK_SHIFT,
+	MAP_CSTICK_DOWN  = 0x08 << MAP_CSTICK_SHIFT,
 };
 
-static int aDefaultProfileConfig[6] = {ID_GCPAD_A, ID_GCPAD_B, ID_GCPAD_START, ID_GCPAD_Z, ID_GCPAD_L, ID_GCPAD_R};
+// Main stick driven by the D-pad keys of aGbaKeyMasks
+static const uint32_t aDpadStick[4] = {MAP_STICK_UP, MAP_STICK_DOWN, MAP_STICK_LEFT, MAP_STICK_RIGHT};
+
+// C-stick on the D-pad while the SHIFT key of the custom profile is held.
+// The other keys of that layer are set in aCustomGameProfileConfig.
+static const uint32_t aShiftDpad[4] = {MAP_CSTICK_UP, MAP_CSTICK_DOWN, MAP_CSTICK_LEFT, MAP_CSTICK_RIGHT};
+
+// Keys pressed together in the shift layer, replacing what they press
+// alone with the chord buttons of aCustomGameProfileConfig
+static const uint16_t aShiftChordKeys[SHIFT_CHORDS] = {KEY_A | KEY_B, KEY_L | KEY_R};
+
+// Macros for the MACRO key of the custom profile, as buttons held for a
+// duration, up to the first step of 0 ms
+#define MACRO_STEPS 4
+
+static const struct {
+	uint16_t buttons, ms;
+} aMacros[MACROS][MACRO_STEPS] = {
+	[MACRO_SHORT_HOP] = {{PAD_BUTTON_X, 33}}, // Released before the third frame
+	[MACRO_FULL_HOP]  = {{PAD_BUTTON_X, 100}},
+	[MACRO_DOUBLE_A]  = {{PAD_BUTTON_A, 50}, {0, 50}, {PAD_BUTTON_A, 50}},
+};
 
 enum {
 	CMD_ID = 0x00,
@@ -161,6 +261,8 @@ static struct {
 			struct { uint8_t x, y; } substick;
 			struct { uint8_t a, b; } button;
 		} mode4;
+
+		uint8_t analog[4];
 	};
 } status;
 
@@ -176,83 +278,78 @@ static struct {
 	.substick = { 128, 128 },
 };
 
-static uint8_t buffer[128];
+// Wire order origin of the custom personality: stick, substick, L and R
+// analog, A and B analog. Meant to be set at build time.
+#ifndef PERSONALITY_CUSTOM_ORIGIN
+#define PERSONALITY_CUSTOM_ORIGIN 128, 128, 128, 128, 0, 0, 0, 0
+#endif
 
-static enum {
-	RUMBLE_NONE = 0,
-	RUMBLE_GBA,
-	RUMBLE_NDS,
-	RUMBLE_NDS_SLIDE,
-	RUMBLE_EZFLASH_OMEGA_DE,
-} rumble;
-static char* rumbleType;
-
-#define EZFLASHOMEGADE_FlashBase_S71		(void*)0x08000000
-#define EZFLASHOMEGADE_SET_info_offset 0x7B0000
-#define EZFLASHOMEGADE_assress_led_open_sel 16
-#define EZFLASHOMEGADE_assress_saveMODE 64
-
-static inline u16 IWRAM_CODE EZFLASHOMEGADE_Read_SET_info(u32 offset)
-{
-	return *((vu16 *)(EZFLASHOMEGADE_FlashBase_S71+EZFLASHOMEGADE_SET_info_offset+offset*2));
-}
+// Fixed parts of the ID and origin replies of each personality, laid out
+// as sent so picking one is a plain copy
+static const struct {
+	uint16_t type;
+	uint8_t origin[8];
+	bool motor;
+} aPersonalities[PERSONALITIES] = {
+	[PERSONALITY_PAD]       = {0x0900, {128, 128, 128, 128, 0, 0, 0, 0}, true},
+	[PERSONALITY_NO_RUMBLE] = {0x2900, {128, 128, 128, 128, 0, 0, 0, 0}, false},
+	[PERSONALITY_WAVEBIRD]  = {0xE9A0, {128, 128, 128, 128, 0, 0, 0, 0}, false},
+	[PERSONALITY_CUSTOM]    = {0x0900, {PERSONALITY_CUSTOM_ORIGIN}, true},
+};
 
-static inline void EZFLASHOMEGADE_SetROMPage( const u16 _page ) {
-  *( vu16 * )0x9fe0000 = 0xd200;
-  *( vu16 * )0x8000000 = 0x1500;
-  *( vu16 * )0x8020000 = 0xd200;
-  *( vu16 * )0x8040000 = 0x1500;
-  *( vu16 * )0x9880000 = _page;
-  *( vu16 * )0x9fc0000 = 0x1500;
-}
+// N64 controller protocol, same bit timing on the same wire
+enum {
+	N64_CMD_INFO = 0x00,
+	N64_CMD_STATUS = 0x01,
+	N64_CMD_RESET = 0xFF
+};
 
-static bool isEzFlashOmegaDefinitiveEdition() {
-	EZFLASHOMEGADE_SetROMPage( 0x8002 ); // Change to kernel mode
-	u16 ledOpenOption = EZFLASHOMEGADE_Read_SET_info(EZFLASHOMEGADE_assress_led_open_sel);
-	u16 norSaveMode = EZFLASHOMEGADE_Read_SET_info(EZFLASHOMEGADE_assress_saveMODE); // Prevent detection of non definitive edition omegas...
-	bool isEzFlashOmegaDefinitiveEdition = (ledOpenOption == 0 || ledOpenOption == 1) && norSaveMode != 65535;
-	EZFLASHOMEGADE_SetROMPage( 0x200 ); // Return to original mode
-	return isEzFlashOmegaDefinitiveEdition;
-}
+enum {
+	N64_CRIGHT = 0x0001,
+	N64_CLEFT  = 0x0002,
+	N64_CDOWN  = 0x0004,
+	N64_CUP    = 0x0008,
+	N64_R      = 0x0010,
+	N64_L      = 0x0020,
+	N64_RIGHT  = 0x0100,
+	N64_LEFT   = 0x0200,
+	N64_DOWN   = 0x0400,
+	N64_UP     = 0x0800,
+	N64_START  = 0x1000,
+	N64_Z      = 0x2000,
+	N64_B      = 0x4000,
+	N64_A      = 0x8000
+};
 
-static bool has_motor(void)
-{
-	switch (ROM[0x59]) {
-		case 0x59:
-			switch (ROM[0xFFFFFF]) {
-				case ~0x0002:
-					rumbleType = "NDS";
-					rumble = RUMBLE_NDS;
-					return true;
-				case ~0x0101:
-					rumbleType = "NDS SLIDE";
-					rumble = RUMBLE_NDS_SLIDE;
-					return true;
-			}
-			break;
-		case 0x96:
-			switch (ROM[0x56] & 0xFF) {
-				case 'R':
-				case 'V':
-					rumbleType = "GBA";
-					rumble = RUMBLE_GBA;
-					return true;
-			}
-			break;
-	}
-	if (isEzFlashOmegaDefinitiveEdition()) {
-		rumbleType = "EZFlash Omega DE";
-		rumble = RUMBLE_EZFLASH_OMEGA_DE;
-		return true;
-	}
-	rumbleType = "No";
-	rumble = RUMBLE_NONE;
-	return false;
-}
+#define N64_STICK_MAX 80
+
+// Buttons of the GBA keys in aGbaKeyMasks order, the D-pad drives the stick
+static const uint16_t aN64KeyButtons[6] = {N64_A, N64_B, N64_START, N64_L, N64_Z, N64_R};
+
+// Standard controller, no pak. Not const, SISetResponse reads replies in
+// its timed loop and they must be in IWRAM like the GameCube ones.
+static struct {
+	uint16_t type;
+	uint8_t status;
+} n64Info = {0x0500, 0x02};
+
+struct n64Status {
+	uint16_t buttons;
+	int8_t x, y;
+};
+
+// Whole status reply for each combination of keys
+static struct n64Status aN64Status[1024] EWRAM_BSS;
+static struct n64Status n64Status;
+STATION_CONST bool bN64 = STATION_CONSOLE == CONSOLE_N64;
+
+static uint8_t buffer[128];
+
+int rumble;
 
 static void set_motor(bool enable)
 {
-	switch (rumble) {
+	switch (RUMBLE_BACKEND) {
 		case RUMBLE_NONE:
 			break;
 		case RUMBLE_GBA:
@@ -279,589 +376,801 @@ static void set_motor(bool enable)
 	}
 }
 
-static char aGbaKeys[10][7] = {
-	"A",
-	"B",
-	"START",
-	"SELECT",
-	"L",
-	"R",
-	"UP",
-	"DOWN",
-	"LEFT",
-	"RIGHT"
-};
+int aCustomGameProfileConfig[CUSTOM_CONFIG];
+static int nTiming;
+static int nGameProfile;
+STATION_CONST bool bPrintKeys = false;
+STATION_CONST bool bDisplayOff = false;
+// Without the sleep option the receiver still drops into STOP after a
+// few idle seconds, leaving the motor and the display alone
+#define IDLE_STOP_SECONDS 4
+STATION_CONST uint32_t nSleepCycles = IDLE_STOP_SECONDS * CLOCK_HZ;
+STATION_CONST bool bDeepSleep = false;
+static uint32_t nLastCommandClock;
+STATION_CONST int nReplayMode = REPLAY_OFF;
+static unsigned nReplayKeys;
+static bool softReset;
+bool hasMotor;
+static int nSiCmdLen;
+#ifndef STATION_PROFILE
+static int (*getCommand)(void *buf, unsigned bits, const uint8_t lengths[256]);
+#endif
+static unsigned gbaInput;
+static unsigned previousGbaInput;
 
-static char aGcPadButtons[12][6] = {
-	"A",
-	"B",
-	"X",
-	"Y",
-	"START",
-	"Z",
-	"L",
-	"R",
-	"UP",
-	"DOWN",
-	"LEFT",
-	"RIGHT",
+enum {
+	ANALOG_L = 0,
+	ANALOG_R,
+	ANALOG_A,
+	ANALOG_B
 };
 
-void SISetResponse(const void *buf, unsigned bits);
-int SIGetCommand(void *buf, unsigned bits);
-
-void consoleSetup(int phase) {
-	consoleInit(0, 4, 0, NULL, 0, 15);
-	if (phase == 1) {
-		// Black background
-		BG_COLORS[0] = RGB8(0, 0, 0);
-	} else if (phase == 2) {
-		// Indigo background (same color as a gc controller)
-		BG_COLORS[0] = RGB8(56, 67, 141);
-	}
-	BG_COLORS[241] = RGB5(31, 31, 31); // Text color (white)
-	SetMode(MODE_0 | BG0_ON);
-}
-
-static bool isGameProfileValid(int* aGameProfileConfig) {
-	bool valid = true;
-	int nGbaKey = 0;
-	while (nGbaKey < 6 && valid) {
-		int nRelatedGcPadButton = aGameProfileConfig[nGbaKey];
-		int i = nGbaKey + 1;
-		while (i < 6 && valid) {
-			if (nRelatedGcPadButton == aGameProfileConfig[i]) {
-				valid = false;
-			} else {
-				i++;
+// GameCube buttons and stick directions for every combination of the 10
+// GBA keys, layers and chords included, plus the buttons no key drives
+static uint32_t aButtonsMap[1024];
+static unsigned nButtonsBase;
+
+static inline unsigned getButtons(const struct buttons *buttons)
+{
+	return ((const uint8_t *)buttons)[0] << 8 | ((const uint8_t *)buttons)[1];
+}
+
+static inline void setButtons(struct buttons *buttons, unsigned mask)
+{
+	((uint8_t *)buttons)[0] = mask >> 8;
+	((uint8_t *)buttons)[1] = mask;
+}
+
+// Turbo and macro engines, stepped once per CMD_STATUS. Turbo keys are
+// held for the first half of each period and released for the other,
+// macro steps press their buttons for a number of polls.
+static unsigned nTurboKeys;
+static int nTurboRate;
+static int nTurboPolls = 2;
+static int nTurboHalf = 1;
+static int nTurboStep;
+static unsigned nMacroKey;
+static int nMacro;
+static int nMacroSteps;
+static int nMacroStep;
+static int nMacroPolls;
+static struct {
+	uint16_t buttons;
+	int polls;
+} aMacroSteps[MACRO_STEPS];
+static unsigned nStatusInput;
+
+// Poll period measured over 64 CMD_STATUS, 60 Hz until then
+static uint32_t nPollCycles = CLOCK_HZ / 60;
+static uint32_t nPollClock;
+static unsigned nStatusPolls;
+
+static void EWRAM_CODE buildButtonsMap(int nGameProfile) {
+	uint32_t aKeyButtons[2][10];
+	uint32_t aChordButtons[SHIFT_CHORDS];
+	unsigned nShiftKey = 0;
+	nTurboKeys = 0;
+	nMacroKey = 0;
+	nMacro = aCustomGameProfileConfig[CUSTOM_MACRO];
+	for (int i = 0; i < 10; i++) {
+		aKeyButtons[0][i] = aGameProfilesButtons[nGameProfile][i];
+		if (nGameProfile == 0 && i < 6) {
+			int nGcPad = aCustomGameProfileConfig[i];
+			aKeyButtons[0][i] = aGcPadMasks[nGcPad];
+			if (nGcPad == ID_GCPAD_TURBO_A || nGcPad == ID_GCPAD_TURBO_B) {
+				nTurboKeys |= aGbaKeyMasks[i];
+			} else if (nGcPad == ID_GCPAD_MACRO) {
+				nMacroKey |= aGbaKeyMasks[i];
+			} else if (nGcPad == ID_GCPAD_WALK) {
+				aKeyButtons[0][i] = MAP_STICK_WALK;
+			} else if (nGcPad == ID_GCPAD_SHIFT) {
+				nShiftKey |= aGbaKeyMasks[i];
 			}
+		} else if (i >= 6) {
+			aKeyButtons[0][i] |= aDpadStick[i - 6];
 		}
-		nGbaKey++;
-	}
-	return valid;
-}
-
-static void printProfileBuilder(int cursorPosition, int* aGameProfileConfig) {
-	char selectedCursor[] = " <==";
-	printf("\x1b[2J"); // clear the screen
-	printf("\n=== Game profile builder ===\n\n");
-	printf("\n   GBA Keys   |   NGC Pad");
-	printf("\n______________|_____________");
-	printf("\n              |\n");
-	for (int i = 0; i < 6; i++) {
-		char* sGbaKey = aGbaKeys[i];
-		char sBlank[11];
-		strcpy(sBlank, "");
-		for (int j = 0; j < 11 - strlen(sGbaKey); j++) {
-			strcat(sBlank, " ");
+		if (i < 6) {
+			aKeyButtons[1][i] = aGcPadMasks[aCustomGameProfileConfig[CUSTOM_SHIFT + i]];
+		} else {
+			aKeyButtons[1][i] = aShiftDpad[i - 6];
 		}
-		printf("   %s%s|   %s%s\n", sGbaKey, sBlank, aGcPadButtons[aGameProfileConfig[i]], i == cursorPosition ? selectedCursor : "");
 	}
-	printf("\n\nUP/DOWN: Navigate");
-	printf("\nLEFT/RIGHT: Change mapping");
-	printf("\n\nSELECT: Set default");
-	if (isGameProfileValid(aGameProfileConfig)) {
-		printf("\nSTART/A: Validate");
-	} else {
-		printf("\nError : invalid game profile");
+	for (int c = 0; c < SHIFT_CHORDS; c++) {
+		aChordButtons[c] = aGcPadMasks[aCustomGameProfileConfig[CUSTOM_CHORDS + c]];
+	}
+
+	// Each combination adds its lowest key to one already built in the
+	// same layer, or a chord to the combination without its keys
+	unsigned nDriven = 0;
+	aButtonsMap[0] = 0;
+	for (int i = 1; i < 1024; i++) {
+		int nLayer = (i & nShiftKey) ? 1 : 0;
+		int nKeys = i & ~nShiftKey;
+		aButtonsMap[i] = 0;
+		if (!nKeys) {
+			continue;
+		}
+		if (nLayer) {
+			int c = 0;
+			while (c < SHIFT_CHORDS &&
+			       ((nKeys & aShiftChordKeys[c]) != aShiftChordKeys[c] || (aShiftChordKeys[c] & nShiftKey))) {
+				c++;
+			}
+			if (c < SHIFT_CHORDS) {
+				aButtonsMap[i] = aButtonsMap[i & ~aShiftChordKeys[c]] | aChordButtons[c];
+				nDriven |= aChordButtons[c];
+				continue;
+			}
+		}
+		int k = 0;
+		while (!(nKeys & aGbaKeyMasks[k])) {
+			k++;
+		}
+		aButtonsMap[i] = aButtonsMap[i & ~aGbaKeyMasks[k]] | aKeyButtons[nLayer][k];
+		nDriven |= aKeyButtons[nLayer][k];
 	}
+	nButtonsBase = getButtons(&origin.buttons) & ~nDriven;
 }
 
-static void showHeader() {
-	printf("\x1b[2J"); // clear the screen
-	printf("\n=== GBA AS NGC CONTROLLER ===");
-	printf("\nCreated by Extremscorner.org");
-	printf("\nModified by Azlino (05-03-21)\n");
+// Polls covering a duration, at least one
+static int EWRAM_CODE pollsFor(uint32_t cycles) {
+	int n = (cycles + nPollCycles / 2) / nPollCycles;
+	if (n < 1) {
+		n = 1;
+	}
+	return n;
 }
 
-static int getPressedButtonsNumber() {
-	unsigned buttons = ~REG_KEYINPUT;
-	int nPressedButtons = 0;
-	if (buttons & KEY_RIGHT) {
-		nPressedButtons++;
-	} else if (buttons & KEY_LEFT) {
-		nPressedButtons++;
+// Durations are rounded to whole polls. A turbo period takes at least two,
+// one pressed and one released, the fastest the console can see.
+static void EWRAM_CODE buildStepTables(void) {
+	nTurboPolls = pollsFor(CLOCK_HZ / nTurboRate);
+	if (nTurboPolls < 2) {
+		nTurboPolls = 2;
 	}
-	if (buttons & KEY_UP) {
-		nPressedButtons++;
-	} else if (buttons & KEY_DOWN) {
-		nPressedButtons++;
+	nTurboHalf = nTurboPolls / 2;
+	nTurboStep = 0;
+
+	nMacroSteps = 0;
+	for (int i = 0; i < MACRO_STEPS && aMacros[nMacro][i].ms; i++) {
+		aMacroSteps[i].buttons = aMacros[nMacro][i].buttons;
+		aMacroSteps[i].polls = pollsFor(aMacros[nMacro][i].ms * (CLOCK_HZ / 1000));
+		nMacroSteps++;
 	}
-	if (buttons & KEY_A) {
-		nPressedButtons++;
+	nMacroStep = nMacroSteps;
+}
+
+// Called every 64 CMD_STATUS, after the reply. Gaps in polling are ignored
+// and the tables only rebuilt when the rate moved by more than 1/8th.
+static void EWRAM_CODE measurePollRate(void) {
+	uint32_t t = clockRead();
+	uint32_t nCycles = (t - nPollClock) / 64;
+	nPollClock = t;
+	if (nCycles > CLOCK_HZ / 10) {
+		return;
 	}
-	if (buttons & KEY_B) {
-		nPressedButtons++;
+	int nDelta = nCycles - nPollCycles;
+	if (nDelta < 0) {
+		nDelta = -nDelta;
 	}
-	if (buttons & KEY_L) {
-		nPressedButtons++;
+	if (nDelta > nPollCycles / 8) {
+		nPollCycles = nCycles;
+		buildStepTables();
+		latencySelect(nGameProfile, nPollCycles);
 	}
-	if (buttons & KEY_R) {
-		nPressedButtons++;
+}
+
+static int nAnalogRamp;
+static int aAnalogPress[4];
+static uint8_t aAnalogRamp[4][ANALOG_RAMP_MAX + 1];
+static uint8_t aStickX[32];
+static uint8_t aStickY[32];
+static uint8_t aCstickX[16];
+static uint8_t aCstickY[16];
+
+static void EWRAM_CODE buildAnalogTables(int nGameProfile) {
+	// Indexed by the stick bits of aButtonsMap (RIGHT, LEFT, UP, DOWN) plus the walk key
+	for (int i = 0; i < 32; i++) {
+		int x = (i & 1) ? 1 : (i & 2) ? -1 : 0;
+		int y = (i & 4) ? 1 : (i & 8) ? -1 : 0;
+		int range = STICK_RANGE;
+		if (i & 16) {
+			range = range * STICK_WALK / 100;
+		}
+		if (x && y) {
+			range = range * STICK_DIAGONAL / 100;
+		}
+		aStickX[i] = origin.stick.x + x * range;
+		aStickY[i] = origin.stick.y + y * range;
+		if (i < 16) {
+			aCstickX[i] = origin.substick.x + x * range;
+			aCstickY[i] = origin.substick.y + y * range;
+		}
 	}
-	if (buttons & KEY_START) {
-		nPressedButtons++;
+
+	// Index 0 is released, then one step per poll until fully pressed
+	nAnalogRamp = aGameProfilesRamp[nGameProfile];
+	if (nAnalogRamp < 1) {
+		nAnalogRamp = 1;
+	} else if (nAnalogRamp > ANALOG_RAMP_MAX) {
+		nAnalogRamp = ANALOG_RAMP_MAX;
+	}
+	int aAnalogOrigin[4] = {origin.trigger.l, origin.trigger.r, origin.button.a, origin.button.b};
+	for (int k = 0; k < 4; k++) {
+		for (int i = 0; i <= nAnalogRamp; i++) {
+			aAnalogRamp[k][i] = aAnalogOrigin[k] + (ANALOG_PRESS - aAnalogOrigin[k]) * i / nAnalogRamp;
+		}
+		aAnalogPress[k] = 0;
 	}
-	if (buttons & KEY_SELECT) {
-		nPressedButtons++;
+}
+
+static inline int stepAnalog(int k, bool pressed) {
+	int n = pressed ? aAnalogPress[k] + (aAnalogPress[k] < nAnalogRamp) : 0;
+	aAnalogPress[k] = n;
+	return aAnalogRamp[k][n];
+}
+
+// Substick bytes for the current analog mode, packed once per mode change
+static uint8_t aSubstick[2];
+
+// Write the analog bytes following the main stick in the layout of each mode,
+// as whole bytes rather than through the big-endian bitfields
+static void packStatusMode0(unsigned l, unsigned r, unsigned a, unsigned b)
+{
+	status.analog[0] = aSubstick[0];
+	status.analog[1] = aSubstick[1];
+	status.analog[2] = (l & 0xF0) | (r >> 4);
+	status.analog[3] = (a & 0xF0) | (b >> 4);
+}
+
+static void packStatusMode1(unsigned l, unsigned r, unsigned a, unsigned b)
+{
+	status.analog[0] = aSubstick[0];
+	status.analog[1] = l;
+	status.analog[2] = r;
+	status.analog[3] = (a & 0xF0) | (b >> 4);
+}
+
+static void packStatusMode2(unsigned l, unsigned r, unsigned a, unsigned b)
+{
+	status.analog[0] = aSubstick[0];
+	status.analog[1] = (l & 0xF0) | (r >> 4);
+	status.analog[2] = a;
+	status.analog[3] = b;
+}
+
+static void packStatusMode3(unsigned l, unsigned r, unsigned a, unsigned b)
+{
+	status.analog[0] = aSubstick[0];
+	status.analog[1] = aSubstick[1];
+	status.analog[2] = l;
+	status.analog[3] = r;
+}
+
+static void packStatusMode4(unsigned l, unsigned r, unsigned a, unsigned b)
+{
+	status.analog[0] = aSubstick[0];
+	status.analog[1] = aSubstick[1];
+	status.analog[2] = a;
+	status.analog[3] = b;
+}
+
+static void (*packStatus)(unsigned l, unsigned r, unsigned a, unsigned b) = packStatusMode0;
+static void (*aStatusPackers[8])(unsigned l, unsigned r, unsigned a, unsigned b) = {
+	packStatusMode0,
+	packStatusMode1,
+	packStatusMode2,
+	packStatusMode3,
+	packStatusMode4,
+	packStatusMode0,
+	packStatusMode0,
+	packStatusMode0,
+};
+static int nStatusMode = -1;
+static uint8_t nSubstickX = 128, nSubstickY = 128;
+static unsigned nCstick;
+
+static void packSubstick(void)
+{
+	switch (id.status.mode) {
+		case 1:
+		case 2:
+			aSubstick[0] = (nSubstickX & 0xF0) | (nSubstickY >> 4);
+			aSubstick[1] = 0;
+			break;
+		default:
+			aSubstick[0] = nSubstickX;
+			aSubstick[1] = nSubstickY;
+			break;
 	}
-	return nPressedButtons;
 }
 
-static void inputReleasedWait() {
-	while (getPressedButtonsNumber() > 0) {
-		VBlankIntrWait();
+static void setStatusMode(int mode)
+{
+	nStatusMode = mode;
+	id.status.mode = mode;
+	packStatus = aStatusPackers[id.status.mode];
+	packSubstick();
+}
+
+// Press latching: keys pressed while waiting for a poll wake the receiver
+// through the keypad interrupt and are reported by the next CMD_STATUS,
+// every press then held for nLatchPolls polls. Keys already down are left
+// out of KEYCNT, the interrupt being level triggered. The receiver masks
+// it in IE when it wakes on a press, keysWoken() unmasks it once the keys
+// are latched and out of KEYCNT. The same wake stamps presses for the
+// latency histogram.
+#define LATCH_POLLS_MAX 8
+#define LATCH_KEYCNT (KEYIRQ_ENABLE | KEYIRQ_OR)
+
+STATION_CONST bool bKeyIrq = false;
+STATION_CONST int nLatchPolls = 0;
+static unsigned nLatchedKeys;
+static unsigned nLatchPrevious;
+static int nLatchRing;
+static unsigned aLatchRing[LATCH_POLLS_MAX];
+STATION_CONST bool bLatency = false;
+static unsigned nEdgeKeys;
+static uint32_t nEdgeClock;
+
+static void keysWoken(void)
+{
+	unsigned keys = ~REG_KEYINPUT & 0x3FF;
+	unsigned nKeyCnt = REG_KEYCNT;
+	if (bLatency && (keys & nKeyCnt)) {
+		if (!nEdgeKeys)
+			nEdgeClock = clockRead();
+		nEdgeKeys |= keys & nKeyCnt;
 	}
+	if (nLatchPolls)
+		nLatchedKeys |= keys;
+	REG_KEYCNT = nKeyCnt & ~keys;
+	REG_IE |= IRQ_KEYPAD;
 }
 
-static void printArt() {
- 	printf("\n\n           ___------__");
-	printf("\n     |\\__-- /\\       _-");
-	printf("\n     |/    __      -");
-	printf("\n     //\\  /  \\    /__");
-	printf("\n     |  o|  0|__     --_");
-	printf("\n     \\\\____-- __ \\   ___-");
-	printf("\n     (@@    __/  / /_");
-	printf("\n        -_____---   --_\n");
+static inline unsigned keysInput(unsigned input)
+{
+	REG_KEYCNT = LATCH_KEYCNT | (0x3FF & ~input);
+	if (!nLatchPolls)
+		return input;
+
+	unsigned keys = (input | nLatchedKeys) & 0x3FF;
+	nLatchedKeys = 0;
+	aLatchRing[nLatchRing] = keys & ~nLatchPrevious;
+	if (++nLatchRing == nLatchPolls)
+		nLatchRing = 0;
+	nLatchPrevious = keys;
+	for (int i = 0; i < nLatchPolls; i++)
+		keys |= aLatchRing[i];
+	return input | keys;
 }
 
-static int aCustomGameProfileConfig[6];
-static int nTiming;
-static int nGameProfile;
-static bool bPrintKeys;
-static bool softReset;
-static bool hasMotor;
-static int nSiCmdLen;
-static int nProfileIterationGbaKey;
-static int nProfileIterationGbaButtonState;
-static unsigned gbaInput;
-static unsigned previousGbaInput;
+// Sensor sampling between polls, latched into the stick tables or the
+// packed substick so that the reply path is unchanged
+#define SENSOR_PERIOD (CLOCK_HZ / 100)
 
-static void configureCustomProfile() {
-	inputReleasedWait();
-	// Entering game profile builder
-	for (int i = 0; i < 6; i++) {
-		aCustomGameProfileConfig[i] = aDefaultProfileConfig[i];
+STATION_CONST int nSensorStick = SENSOR_STICK_OFF;
+static uint32_t nSensorClock;
+
+static void EWRAM_CODE sampleSensor(void)
+{
+	int x = 0, y = 0;
+	int axes = sensorSample(id.status.motor == MOTOR_RUMBLE, &x, &y);
+	if (!axes) {
+		return;
 	}
-	int cursorPosition = 0;
-	bool validated = false;
-	printProfileBuilder(cursorPosition, aCustomGameProfileConfig);
-	while (!validated) {
-		VBlankIntrWait();
-		bool refreshed = false;
-		unsigned gbaInput = ~REG_KEYINPUT;
-		if ((gbaInput & KEY_START) || (gbaInput & KEY_A)) {
-			// Validate
-			if (isGameProfileValid(aCustomGameProfileConfig)) {
-				validated = true;
-			}
-		} else if (gbaInput & KEY_SELECT) {
-			// Set default mapping
-			for (int i = 0; i < 6; i++) {
-				aCustomGameProfileConfig[i] = aDefaultProfileConfig[i];
-			}
-			refreshed = true;
-		} else if (gbaInput & KEY_UP) {
-			if (cursorPosition > 0) {
-				cursorPosition--;
-				refreshed = true;
-			}
-		} else if (gbaInput & KEY_DOWN) {
-			if (cursorPosition < 5) {
-				cursorPosition++;
-				refreshed = true;
-			}
-		} else if (gbaInput & KEY_RIGHT) {
-			if (aCustomGameProfileConfig[cursorPosition] >= 11) {
-				aCustomGameProfileConfig[cursorPosition] = 0;
-			} else {
-				aCustomGameProfileConfig[cursorPosition]++;
-			}
-			refreshed = true;
-		} else if (gbaInput & KEY_LEFT) {
-			if (aCustomGameProfileConfig[cursorPosition] == 0) {
-				aCustomGameProfileConfig[cursorPosition] = 11;
-			} else {
-				aCustomGameProfileConfig[cursorPosition]--;
-			}
-			refreshed = true;
-		}
-		if (refreshed) {
-			printProfileBuilder(cursorPosition, aCustomGameProfileConfig);
-			inputReleasedWait();
+	x = x < -STICK_RANGE ? -STICK_RANGE : x > STICK_RANGE ? STICK_RANGE : x;
+	y = y < -STICK_RANGE ? -STICK_RANGE : y > STICK_RANGE ? STICK_RANGE : y;
+	if (nSensorStick == SENSOR_STICK_MAIN) {
+		for (int i = 0; i < 32; i++) {
+			if (axes & SENSOR_X)
+				aStickX[i] = origin.stick.x + x;
+			if (axes & SENSOR_Y)
+				aStickY[i] = origin.stick.y + y;
 		}
+	} else {
+		if (axes & SENSOR_X)
+			nSubstickX = origin.substick.x + x;
+		if (axes & SENSOR_Y)
+			nSubstickY = origin.substick.y + y;
+		packSubstick();
 	}
 }
 
-static void printConfigurePrintKeys(bool bPrintKeys)
+// Runs once, after the first reply to the console
+static void EWRAM_CODE controllerLive(void)
 {
-	showHeader();
-	printf("\n==== Print Pressed Keys ====\n\n");
-	printf("\nEnabled : %s", bPrintKeys ? "true" : "false");
-	printf("\n\n\nRIGHT/LEFT: Change");
-	printf("\n\nSTART/A: Validate");
-	printf("\n\nWarning : this feature reduce the compatibility and might\nreduce the stability of this\nGBA as NGC controller !");
+	bootMark(BOOT_FIRST_REPLY);
+#ifdef POWER_STATS
+	powerStart();
+#endif
+	if (bDisplayOff)
+		REG_DISPCNT |= LCDC_OFF;
 }
 
-static int configurePrintKeys()
+// Received length of each command in bits, stop bit included, 0 for the
+// commands we do not answer. The receiver returns as soon as it is reached.
+// The descriptors of the few commands answered are packed, aCommandSlots
+// gives the one of each command byte.
+#define COMMANDS_MAX 6
+
+static uint8_t aCommandBits[256];
+static uint8_t aCommandSlots[256];
+static struct command aCommands[COMMANDS_MAX];
+static int nCommands;
+static unsigned nButtons;
+
+static void cmdReply(const struct command *cmd)
 {
-	bool validated = false;
-	bool bPrintKeys = false;
-	printConfigurePrintKeys(bPrintKeys);
-	while (!validated) {
-		VBlankIntrWait();
-		unsigned buttons = ~REG_KEYINPUT;
-		if ((buttons & KEY_START) || (buttons & KEY_A)) {
-			validated = true;
-		} else if ((buttons & KEY_LEFT) || (buttons & KEY_RIGHT)) {
-			bPrintKeys = !bPrintKeys;
-			printConfigurePrintKeys(bPrintKeys);
-			inputReleasedWait();
-		}
+	SISetResponse(cmd->reply, cmd->replyBits);
+}
+
+static void cmdId(const struct command *cmd)
+{
+	SISetResponse(cmd->reply, cmd->replyBits);
+	if (nBootPhase == BOOT_FIRST_REPLY)
+		controllerLive();
+}
+
+static void cmdReset(const struct command *cmd)
+{
+	id.status.motor = MOTOR_STOP;
+	cmdId(cmd);
+}
+
+static void cmdStatus(const struct command *cmd)
+{
+	if (buffer[1] != nStatusMode)
+		setStatusMode(buffer[1]);
+	id.status.motor = buffer[2];
+	if (gbaInput & nTurboKeys) {
+		if (nTurboStep >= nTurboHalf)
+			nButtons = aButtonsMap[(gbaInput & ~nTurboKeys) & 0x3FF] | nButtonsBase;
+		if (++nTurboStep == nTurboPolls)
+			nTurboStep = 0;
+	} else
+		nTurboStep = 0;
+	if (gbaInput & ~nStatusInput & nMacroKey) {
+		nMacroStep = 0;
+		nMacroPolls = aMacroSteps[0].polls;
 	}
-	inputReleasedWait();
-	return bPrintKeys;
+	if (nMacroStep < nMacroSteps) {
+		nButtons |= aMacroSteps[nMacroStep].buttons;
+		if (--nMacroPolls == 0 && ++nMacroStep < nMacroSteps)
+			nMacroPolls = aMacroSteps[nMacroStep].polls;
+	}
+	nStatusInput = gbaInput;
+	setButtons(&status.buttons, nButtons);
+	unsigned nStick = (nButtons >> MAP_STICK_SHIFT) & 0x1F;
+	status.stick.x = aStickX[nStick];
+	status.stick.y = aStickY[nStick];
+	if (((nButtons >> MAP_CSTICK_SHIFT) & 0xF) != nCstick) {
+		nCstick = (nButtons >> MAP_CSTICK_SHIFT) & 0xF;
+		nSubstickX = aCstickX[nCstick];
+		nSubstickY = aCstickY[nCstick];
+		packSubstick();
+	}
+	packStatus(stepAnalog(ANALOG_L, nButtons & PAD_TRIGGER_L),
+	           stepAnalog(ANALOG_R, nButtons & PAD_TRIGGER_R),
+	           stepAnalog(ANALOG_A, nButtons & PAD_BUTTON_A),
+	           stepAnalog(ANALOG_B, nButtons & PAD_BUTTON_B));
+	PROF_END(PROF_MAPPING);
+	PROF_BEGIN(PROF_REPLY);
+	SISetResponse(cmd->reply, cmd->replyBits);
+	PROF_END(PROF_REPLY);
+	if (nEdgeKeys) {
+		// Taps missed without latching are not counted
+		if (gbaInput & nEdgeKeys)
+			latencyRecord(clockRead() - nEdgeClock);
+		nEdgeKeys = 0;
+	}
+	if (nReplayMode == REPLAY_RECORD)
+		replayRecord(gbaInput);
+	if (++nStatusPolls % 64 == 0)
+		measurePollRate();
+	if (nBootPhase == BOOT_FIRST_REPLY)
+		controllerLive();
 }
 
-static void printTimingSelect(int nTiming)
+// Also CMD_STATUS_LONG, answered with the origin
+static void cmdRecalibrate(const struct command *cmd)
 {
-	showHeader();
-	printf("\n======= Joybus config =======\n\n");
-	printf("\nCurrent timing : ");
-	printf("\n> %d (%.2f microseconds)", nTiming, 0.05959 * nTiming);
-	printf("\n\n\nUP: +1 (slower)");
-	printf("\nDOWN: -1 (faster)");
-	printf("\n\nSELECT: Set default");
-	printf("\nSTART/A: Validate");
+	if (buffer[1] != nStatusMode)
+		setStatusMode(buffer[1]);
+	id.status.motor = buffer[2];
+	SISetResponse(cmd->reply, cmd->replyBits);
 }
 
-static int timingSelect()
+static void cmdN64Status(const struct command *cmd)
 {
-	int nTiming = 67;
-	bool validated = false;
-	printTimingSelect(nTiming);
-	while (!validated) {
-		VBlankIntrWait();
-		bool refreshed = false;
-		unsigned buttons = ~REG_KEYINPUT;
-		if ((buttons & KEY_START) || (buttons & KEY_A)) {
-			validated = true;
-		} else if (buttons & KEY_SELECT) {
-			nTiming = 67;
-			refreshed = true;
-		} else if (buttons & KEY_UP) {
-			if (nTiming < 100) {
-				nTiming++;
-				refreshed = true;
-			}
-		} else if (buttons & KEY_DOWN) {
-			if (nTiming > 50) {
-				nTiming--;
-				refreshed = true;
-			}
-		}
-		if (refreshed)
-		{
-			printTimingSelect(nTiming);
-			inputReleasedWait();
+	n64Status = aN64Status[gbaInput & 0x3FF];
+	PROF_END(PROF_MAPPING);
+	PROF_BEGIN(PROF_REPLY);
+	SISetResponse(cmd->reply, cmd->replyBits);
+	PROF_END(PROF_REPLY);
+	if (nBootPhase == BOOT_FIRST_REPLY)
+		controllerLive();
+}
+
+static void EWRAM_CODE addCommand(int nCmd, int nBits, void (*handler)(const struct command *cmd),
+                                  const void *reply, unsigned nReplyBits)
+{
+	aCommandBits[nCmd] = nBits;
+	aCommandSlots[nCmd] = nCommands;
+	aCommands[nCommands].handler = handler;
+	aCommands[nCommands].reply = reply;
+	aCommands[nCommands].replyBits = nReplyBits;
+	nCommands++;
+}
+
+static void EWRAM_CODE applyPersonality(int n)
+{
+	if (n == PERSONALITY_AUTO)
+		n = hasMotor ? PERSONALITY_PAD : PERSONALITY_NO_RUMBLE;
+	id.type = aPersonalities[n].type;
+	uint8_t *pOrigin = (uint8_t *)&origin.stick;
+	for (int i = 0; i < sizeof(aPersonalities[n].origin); i++)
+		pOrigin[i] = aPersonalities[n].origin[i];
+	if (!aPersonalities[n].motor)
+		hasMotor = false;
+}
+
+static void EWRAM_CODE buildN64Map(void)
+{
+	for (int i = 0; i < 1024; i++) {
+		uint16_t nButtons = 0;
+		for (int k = 0; k < 6; k++) {
+			if (i & aGbaKeyMasks[k])
+				nButtons |= aN64KeyButtons[k];
 		}
+		int x = !!(i & KEY_RIGHT) - !!(i & KEY_LEFT);
+		int y = !!(i & KEY_UP) - !!(i & KEY_DOWN);
+		int range = x && y ? N64_STICK_MAX * STICK_DIAGONAL / 100 : N64_STICK_MAX;
+		aN64Status[i].buttons = nButtons;
+		aN64Status[i].x = x * range;
+		aN64Status[i].y = y * range;
 	}
-	nTiming = - nTiming;
-	printf("\n\nTimer set to : %d", nTiming);
-	inputReleasedWait();
-	return nTiming;
-}
-
-static int profileSelect() {
-	showHeader();
-	printf("\nChoose a game profile :");
-	printf("\nSELECT: Make custom profile");
-	printf("\nA: %s", aGameProfilesNames[1]);
-	printf("\nB: %s", aGameProfilesNames[2]);
-	printf("\nL: %s", aGameProfilesNames[3]);
-	printf("\nR: %s", aGameProfilesNames[4]);
-	printf("\nUP: %s", aGameProfilesNames[5]);
-	printf("\nRIGHT: %s", aGameProfilesNames[6]);
-	int nGameProfile = -1;
-	while (nGameProfile == -1) {
-		VBlankIntrWait();
-		unsigned buttons = ~REG_KEYINPUT;
-		if (buttons & KEY_SELECT) {
-			nGameProfile = 0; // Custom
-		} else if (buttons & KEY_A) {
-			nGameProfile = 1; // Default
-		} else if (buttons & KEY_B) {
-			nGameProfile = 2; // Super Smash Ultimate
-		} else if (buttons & KEY_START) {
-			nGameProfile = -1;
-		} else if (buttons & KEY_L) {
-			nGameProfile = 3; // Mario Kart Double Dash
-		} else if (buttons & KEY_R) {
-			nGameProfile = 4; // Mario Kart 8 Deluxe
-		} else if (buttons & KEY_UP) {
-			nGameProfile = 5; // New Super Mario Bros
-		} else if (buttons & KEY_DOWN) {
-			nGameProfile = -1;
-		} else if (buttons & KEY_LEFT) {
-			nGameProfile = -1;
-		} else if (buttons & KEY_RIGHT) {
-			nGameProfile = 6; // Mario Kart Wii
-		}
+}
+
+static void EWRAM_CODE buildCommands(void)
+{
+	for (int i = 0; i < 256; i++)
+		aCommandBits[i] = 0;
+	nCommands = 0;
+	if (bN64) {
+		addCommand(N64_CMD_INFO, 9, cmdId, &n64Info, sizeof(n64Info) * 8);
+		addCommand(N64_CMD_RESET, 9, cmdId, &n64Info, sizeof(n64Info) * 8);
+		addCommand(N64_CMD_STATUS, 9, cmdN64Status, &n64Status, sizeof(n64Status) * 8);
+		return;
 	}
-	if (nGameProfile == 0) {
-		configureCustomProfile();
+	addCommand(CMD_ID, 9, cmdId, &id, sizeof(id) * 8);
+	addCommand(CMD_RESET, 9, cmdReset, &id, sizeof(id) * 8);
+	addCommand(CMD_STATUS, 25, cmdStatus, &status, sizeof(status) * 8);
+	addCommand(CMD_ORIGIN, 9, cmdReply, &origin, sizeof(origin) * 8);
+	addCommand(CMD_RECALIBRATE, 25, cmdRecalibrate, &origin, sizeof(origin) * 8);
+	addCommand(CMD_STATUS_LONG, 25, cmdRecalibrate, &origin, sizeof(origin) * 8);
+}
+
+// Nothing valid was polled for a while, the console is off or unplugged.
+// Wait in STOP for an edge. With the sleep option the motor and the
+// display are released first and any key press wakes as well. The waking
+// command is returned to be answered as usual.
+static int EWRAM_CODE deepSleep(void)
+{
+	uint16_t nDispCnt = REG_DISPCNT;
+	uint16_t nKeyCnt = REG_KEYCNT;
+	uint16_t nIe = REG_IE;
+	if (bDeepSleep) {
+		id.status.motor = MOTOR_STOP;
+		set_motor(false);
+		REG_DISPCNT = nDispCnt | LCDC_OFF;
+		REG_KEYCNT = KEYIRQ_ENABLE | KEYIRQ_OR | 0x03FF; // Any key
+		REG_IE = nIe | IRQ_KEYPAD;
 	}
-	hasMotor = has_motor(); // Define motor
-	printf("\n\nSelected game profile :\n> %s", aGameProfilesNames[nGameProfile]);
-	inputReleasedWait();
-	return nGameProfile;
+
+	int nLen = SISleepCommand(buffer, sizeof(buffer) * 8 + 1, aCommandBits);
+
+	REG_IE = nIe;
+	REG_KEYCNT = nKeyCnt;
+	REG_DISPCNT = nDispCnt;
+	nLastCommandClock = clockRead();
+	return nLen;
 }
 
-int main(void)
+static void EWRAM_CODE setup(void)
 {
+	bootStart();
+#ifndef STATION_PROFILE
 	irqInit();
 	irqEnable(IRQ_VBLANK);
+	bootMark(BOOT_IRQ_INIT);
 	consoleSetup(1);
+	bootMark(BOOT_CONSOLE);
 	if (getPressedButtonsNumber() > 0) {
 		showHeader();
-		printf("\nPlease release all buttons to\ncontinue...");
+		textPuts("\nPlease release all buttons to\ncontinue...");
 	}
 	inputReleasedWait();
-	bPrintKeys = configurePrintKeys();
+	bootMark(BOOT_RELEASE);
+	configureOptions();
+	bPrintKeys = aOptions[OPTION_PRINT_KEYS];
+	bDisplayOff = aOptions[OPTION_DISPLAY_OFF];
+	bDeepSleep = aOptions[OPTION_SLEEP] != 0;
+	nSleepCycles = (bDeepSleep ? aOptions[OPTION_SLEEP] : IDLE_STOP_SECONDS) * CLOCK_HZ;
+	bootMark(BOOT_MENU_OPTIONS);
 	nTiming = timingSelect();
+	bootMark(BOOT_MENU_TIMING);
 	nGameProfile = profileSelect();
+	bootMark(BOOT_MENU_PROFILE);
+	hasMotor = has_motor(); // Define motor
+	applyPersonality(aOptions[OPTION_PERSONALITY]);
+	bootMark(BOOT_RUMBLE_DETECT);
+	nSensorStick = sensorDetect() ? aOptions[OPTION_SENSOR] : SENSOR_STICK_OFF;
+	nLatchPolls = aOptions[OPTION_LATCH];
+	bLatency = aOptions[OPTION_LATENCY];
+	switch (aOptions[OPTION_RECEIVER]) {
+		case SI_RECEIVER_SPIN:
+			getCommand = SIGetCommandSpin;
+			break;
+		case SI_RECEIVER_IRQ:
+			getCommand = SIGetCommandIrq;
+			break;
+		default:
+			getCommand = SIGetCommand;
+			break;
+	}
+	bKeyIrq = nLatchPolls || bLatency;
+	nReplayMode = aOptions[OPTION_REPLAY];
+	if (!replayStart(nReplayMode) && nReplayMode == REPLAY_PLAY)
+		nReplayMode = REPLAY_OFF; // Nothing recorded
+	bN64 = aOptions[OPTION_CONSOLE] == CONSOLE_N64;
+	nTurboRate = aOptions[OPTION_TURBO_RATE];
+#else
+	nTiming = STATION_TIMING;
+	nGameProfile = STATION_PROFILE;
+	rumble = STATION_RUMBLE;
+	hasMotor = rumble != RUMBLE_NONE;
+	applyPersonality(PERSONALITY_AUTO);
+	nTurboRate = 10;
+#endif
+	nSubstickX = origin.substick.x;
+	nSubstickY = origin.substick.y;
+	nCstick = 0;
+	nStatusMode = -1; // Packers picked again on the first CMD_STATUS
+	packSubstick();
+	nEdgeKeys = 0;
+	nLatchedKeys = 0;
+	nLatchPrevious = 0;
+	nLatchRing = 0;
+	for (int i = 0; i < LATCH_POLLS_MAX; i++)
+		aLatchRing[i] = 0;
+	nReplayKeys = 0;
+	buildCommands();
+	if (bN64)
+		buildN64Map();
+	buildButtonsMap(nGameProfile);
+	buildStepTables();
+	latencySelect(nGameProfile, nPollCycles);
+	buildAnalogTables(nGameProfile);
+	bootMark(BOOT_TABLES);
 	softReset = false;
 	previousGbaInput = 0;
 	
+	// The register reset stops the cycle counter, carry it over and
+	// account for the reset itself in scanlines
+	uint32_t nBootClock = clockRead();
+	int nBootLine = REG_VCOUNT;
 	RegisterRamReset(RESET_ALL_REG);
+	int nResetLines = REG_VCOUNT - nBootLine;
+	if (nResetLines < 0)
+		nResetLines += 228;
+	clockStart(nBootClock + nResetLines * 1232);
+	bootMark(BOOT_REGISTER_RESET);
+#ifndef STATION_PROFILE
+	showControllerScreen(nGameProfile);
+	bootMark(BOOT_SCREEN);
+#endif
 
-	consoleSetup(2);
-	showHeader();
-	printf("\nGame profile :");
-	printf("\n> %s", aGameProfilesNames[nGameProfile]);
-	printf("\nRumble : %s", rumbleType);
-	printArt();
-	printf("\n\nPush A+B+SELECT+START to reset");
-
-	REG_IE = IRQ_SERIAL | IRQ_TIMER2 | IRQ_TIMER1 | IRQ_TIMER0;
+	REG_IE = IRQ_SERIAL | IRQ_TIMER1 | IRQ_TIMER0;
+	if (bKeyIrq) {
+		REG_KEYCNT = LATCH_KEYCNT | 0x3FF;
+		REG_IE |= IRQ_KEYPAD;
+	}
 	REG_IF = REG_IF;
 
 	REG_RCNT = R_GPIO | GPIO_IRQ | GPIO_SO_IO | GPIO_SO;
 
 	REG_TM0CNT_L = nTiming;
-	REG_TM1CNT_H = TIMER_START | TIMER_IRQ | TIMER_COUNT;
 	REG_TM0CNT_H = TIMER_START;
+	REG_TM1CNT_L = SI_IDLE_RELOAD;
+	if (getCommand == SIGetCommandIrq)
+		INT_VECTOR = SIIrq; // Replaces the libgba dispatcher until the next setup
 
 	SoundBias(0);
+	bootMark(BOOT_SI_SETUP);
+	nLastCommandClock = nPollClock = clockRead();
+#ifdef PROFILE
+	profReset();
+	if (getCommand == SIGetCommandIrq) {
+		for (int i = 0; i < 16; i++)
+			profSample(PROF_SI_IRQ, SIIrqLatency());
+		REG_TM0CNT_L = nTiming;
+		REG_TM0CNT_H = TIMER_START;
+	}
+#endif
 	Halt();
+}
+
+int main(void)
+{
+	setup();
 
 	while (!softReset) {
-		nSiCmdLen = SIGetCommand(buffer, sizeof(buffer) * 8 + 1);
-		if (nSiCmdLen < 9) continue;
+		nSiCmdLen = getCommand(buffer, sizeof(buffer) * 8 + 1, aCommandBits);
+		if (nSiCmdLen < 9) {
+			if (bKeyIrq)
+				keysWoken();
+			if (clockRead() - nLastCommandClock < nSleepCycles)
+				continue;
+			nSiCmdLen = deepSleep();
+			if (nSiCmdLen < 9) continue;
+		}
+
+		// The receiver returned on the stop bit with timer 0 restarted.
+		// As when it ran into the timeout, the reply goes out nTiming
+		// after the stop bit plus the mapping and handler work below.
+		if (nSiCmdLen == aCommandBits[buffer[0]])
+			while (!(REG_IF & IRQ_TIMER0));
 
+		PROF_BEGIN(PROF_MAPPING);
 		gbaInput = ~REG_KEYINPUT;
 		softReset = gbaInput == -1009; // Softreset A B START SELECT
-		switch (nGameProfile) {
-			case 1: // Default
-				origin.buttons.a     = !!(gbaInput & KEY_A);
-				origin.buttons.b     = !!(gbaInput & KEY_B);
-				origin.buttons.start = !!(gbaInput & KEY_START);
-				origin.buttons.z     = !!(gbaInput & KEY_SELECT);
-				origin.buttons.l     = !!(gbaInput & KEY_L);
-				origin.buttons.r     = !!(gbaInput & KEY_R);
-				break;
-			case 2: // Super Smash Ultimate
-				origin.buttons.a     = !!(gbaInput & KEY_A);
-				origin.buttons.b     = !!(gbaInput & KEY_B);
-				origin.buttons.start = !!(gbaInput & KEY_START);
-				origin.buttons.x     = !!(gbaInput & KEY_SELECT);
-				origin.buttons.l     = !!(gbaInput & KEY_L);
-				origin.buttons.z     = !!(gbaInput & KEY_R);
-				break;
-			case 3: // Mario Kart Double Dash
-				origin.buttons.a     = !!(gbaInput & KEY_A);
-				origin.buttons.z     = !!(gbaInput & KEY_B);
-				origin.buttons.start = !!(gbaInput & KEY_START);
-				origin.buttons.b     = !!(gbaInput & KEY_SELECT);
-				origin.buttons.x     = !!(gbaInput & KEY_L);
-				origin.buttons.r     = !!(gbaInput & KEY_R);
-				break;
-			case 4: // Mario Kart 8 Deluxe
-				origin.buttons.a     = !!(gbaInput & KEY_A);
-				origin.buttons.b     = !!(gbaInput & KEY_B);
-				origin.buttons.start = !!(gbaInput & KEY_START);
-				origin.buttons.x     = !!(gbaInput & KEY_SELECT);
-				origin.buttons.l     = !!(gbaInput & KEY_L);
-				origin.buttons.r     = !!(gbaInput & KEY_R);
-				break;
-			case 5: // New Super Mario Bros
-				origin.buttons.a     = !!(gbaInput & KEY_A);
-				origin.buttons.y     = !!(gbaInput & KEY_B);
-				origin.buttons.start = !!(gbaInput & KEY_START);
-				origin.buttons.b     = !!(gbaInput & KEY_SELECT);
-				origin.buttons.l     = !!(gbaInput & KEY_L);
-				origin.buttons.r     = !!(gbaInput & KEY_R);
-				break;
-			case 6: // Mario Kart Wii
-				origin.buttons.a     = !!(gbaInput & KEY_A);
-				origin.buttons.x     = !!(gbaInput & KEY_B);
-				origin.buttons.start = !!(gbaInput & KEY_START);
-				origin.buttons.l     = !!(gbaInput & KEY_L);
-				origin.buttons.b     = !!(gbaInput & KEY_R);
-				origin.buttons.up    = !!(gbaInput & KEY_UP);
-				origin.buttons.down  = !!(gbaInput & KEY_DOWN);
-				break;
-			case 0: // Custom profile
-				nProfileIterationGbaKey = 5;
-				while (nProfileIterationGbaKey >= 0) {
-					switch (nProfileIterationGbaKey) {
-						case ID_GBAKEY_A:
-						nProfileIterationGbaButtonState = !!(gbaInput & KEY_A);
-						break;
-						case ID_GBAKEY_B:
-						nProfileIterationGbaButtonState = !!(gbaInput & KEY_B);
-						break;
-						case ID_GBAKEY_START:
-						nProfileIterationGbaButtonState = !!(gbaInput & KEY_START);
-						break;
-						case ID_GBAKEY_SELECT:
-						nProfileIterationGbaButtonState = !!(gbaInput & KEY_SELECT);
-						break;
-						case ID_GBAKEY_L:
-						nProfileIterationGbaButtonState = !!(gbaInput & KEY_L);
-						break;
-						case ID_GBAKEY_R:
-						nProfileIterationGbaButtonState = !!(gbaInput & KEY_R);
-						break;
-					}
-					switch (aCustomGameProfileConfig[nProfileIterationGbaKey]) {
-						case ID_GCPAD_A:
-						origin.buttons.a = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_B:
-						origin.buttons.b = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_X:
-						origin.buttons.x = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_Y:
-						origin.buttons.y = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_START:
-						origin.buttons.start = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_Z:
-						origin.buttons.z = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_L:
-						origin.buttons.l = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_R:
-						origin.buttons.r = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_UP:
-						origin.buttons.up = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_DOWN:
-						origin.buttons.down = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_LEFT:
-						origin.buttons.left = nProfileIterationGbaButtonState;
-						break;
-						case ID_GCPAD_RIGHT:
-						origin.buttons.right = nProfileIterationGbaButtonState;
-						break;
-					}
-					nProfileIterationGbaKey--;
+		// The N64 status reply is a single table load in its handler
+		if (!bN64) {
+			if (bKeyIrq && buffer[0] == CMD_STATUS && nSiCmdLen == 25)
+				gbaInput = keysInput(gbaInput);
+#ifndef STATION_PROFILE
+			if (nReplayMode == REPLAY_PLAY) {
+				// Recorded keys through the same mapping, live keys once it ends
+				if (buffer[0] == CMD_STATUS && nSiCmdLen == 25) {
+					int nKeys = replayNext();
+					if (nKeys < 0)
+						nReplayMode = REPLAY_OFF;
+					else
+						nReplayKeys = nKeys;
 				}
-				break;
+				if (nReplayMode == REPLAY_PLAY)
+					gbaInput = nReplayKeys;
+			}
+#endif
+			nButtons = aButtonsMap[gbaInput & 0x3FF] | nButtonsBase;
+			setButtons(&origin.buttons, nButtons);
+			
+			origin.buttons.unknown = 
+			id.status.unknown = origin.buttons.unknown;
 		}
 		
-		origin.buttons.unknown = 
-		id.status.unknown = origin.buttons.unknown;
-		
-		switch (buffer[0]) {
-			case CMD_RESET:
-				id.status.motor = MOTOR_STOP;
-			case CMD_ID:
-				if (nSiCmdLen == 9) {
-					if (hasMotor) {
-						id.type = 0x0900;
-					} else {
-						id.type = 0x2900;
-					}
-					SISetResponse(&id, sizeof(id) * 8);
-				}
-				break;
-			case CMD_STATUS:
-				if (nSiCmdLen == 25) {
-					id.status.mode  = buffer[1];
-					id.status.motor = buffer[2];
-					status.buttons = origin.buttons;
-					status.stick.x = origin.stick.x;
-					status.stick.y = origin.stick.y;
-					if (gbaInput & KEY_RIGHT)
-						status.stick.x = origin.stick.x + 100;
-					else if (gbaInput & KEY_LEFT)
-						status.stick.x = origin.stick.x - 100;
-					if (gbaInput & KEY_UP)
-						status.stick.y = origin.stick.y + 100;
-					else if (gbaInput & KEY_DOWN)
-						status.stick.y = origin.stick.y - 100;
-					switch (id.status.mode) {
-						default:
-							status.mode0.substick.x = origin.substick.x;
-							status.mode0.substick.y = origin.substick.y;
-							status.mode0.trigger.l  = (status.buttons.l ? 200 : origin.trigger.l) >> 4;
-							status.mode0.trigger.r  = (status.buttons.r ? 200 : origin.trigger.r) >> 4;
-							status.mode0.button.a   = (status.buttons.a ? 200 : origin.button.a) >> 4;
-							status.mode0.button.b   = (status.buttons.b ? 200 : origin.button.b) >> 4;
-							break;
-						case 1:
-							status.mode1.substick.x = origin.substick.x >> 4;
-							status.mode1.substick.y = origin.substick.y >> 4;
-							status.mode1.trigger.l  = (status.buttons.l ? 200 : origin.trigger.l);
-							status.mode1.trigger.r  = (status.buttons.r ? 200 : origin.trigger.r);
-							status.mode1.button.a   = (status.buttons.a ? 200 : origin.button.a) >> 4;
-							status.mode1.button.b   = (status.buttons.b ? 200 : origin.button.b) >> 4;
-							break;
-						case 2:
-							status.mode2.substick.x = origin.substick.x >> 4;
-							status.mode2.substick.y = origin.substick.y >> 4;
-							status.mode2.trigger.l  = (status.buttons.l ? 200 : origin.trigger.l) >> 4;
-							status.mode2.trigger.r  = (status.buttons.r ? 200 : origin.trigger.r) >> 4;
-							status.mode2.button.a   = (status.buttons.a ? 200 : origin.button.a);
-							status.mode2.button.b   = (status.buttons.b ? 200 : origin.button.b);
-							break;
-						case 3:
-							status.mode3.substick.x = origin.substick.x;
-							status.mode3.substick.y = origin.substick.y;
-							status.mode3.trigger.l  = (status.buttons.l ? 200 : origin.trigger.l);
-							status.mode3.trigger.r  = (status.buttons.r ? 200 : origin.trigger.r);
-							break;
-						case 4:
-							status.mode4.substick.x = origin.substick.x;
-							status.mode4.substick.y = origin.substick.y;
-							status.mode4.button.a   = (status.buttons.a ? 200 : origin.button.a);
-							status.mode4.button.b   = (status.buttons.b ? 200 : origin.button.b);
-							break;
-					}
-					SISetResponse(&status, sizeof(status) * 8);
-				}
-				break;
-			case CMD_ORIGIN:
-				if (nSiCmdLen == 9) SISetResponse(&origin, sizeof(origin) * 8);
-				break;
-			case CMD_RECALIBRATE:
-			case CMD_STATUS_LONG:
-				if (nSiCmdLen == 25) {
-					id.status.mode  = buffer[1];
-					id.status.motor = buffer[2];
-					SISetResponse(&origin, sizeof(origin) * 8);
-				}
-				break;
+		if (nSiCmdLen == aCommandBits[buffer[0]]) {
+			const struct command *cmd = &aCommands[aCommandSlots[buffer[0]]];
+			cmd->handler(cmd);
+#ifdef PROFILE
+			profSample(buffer[0] == (bN64 ? N64_CMD_STATUS : CMD_STATUS) ? PROF_TURN_POLL : PROF_TURN_CMD,
+			           nProfTurnaround);
+#endif
+		}
+		// A press during the command, latched once the reply is out
+		if (bKeyIrq && !(REG_IE & IRQ_KEYPAD))
+			keysWoken();
+		PROF_BEGIN(PROF_MOTOR);
+		set_motor(!softReset && hasMotor && id.status.motor == MOTOR_RUMBLE);
+		PROF_END(PROF_MOTOR);
+		nLastCommandClock = clockRead();
+		if (nSensorStick && nLastCommandClock - nSensorClock >= SENSOR_PERIOD) {
+			nSensorClock = nLastCommandClock;
+			PROF_BEGIN(PROF_SENSOR);
+			sampleSensor();
+			PROF_END(PROF_SENSOR);
 		}
-		set_motor(!softReset && id.status.motor == MOTOR_RUMBLE);
 		if (softReset) {			
 			// Reset all inputs to initial state
 			// Fix key press not released when switching on a different profile
@@ -879,25 +1188,32 @@ int main(void)
 			origin.buttons.down       = 0;
 			origin.buttons.left       = 0;
 			origin.buttons.right      = 0;
-		} else if (bPrintKeys) {
-			if (gbaInput != previousGbaInput) {
+		} else {
+			if (bPrintKeys && gbaInput != previousGbaInput) {
 				// New input
-				printf("\033[5;0H%s\033[5;0H%s%s%s%s%s%s%s%s%s%s", 
-				"                          ",
-				(gbaInput & KEY_A) ? "A " : "",
-				(gbaInput & KEY_B) ? "B " : "",
-				(gbaInput & KEY_START) ? "STA " : "",
-				(gbaInput & KEY_SELECT) ? "SEL " : "",
-				(gbaInput & KEY_L) ? "L " : "",
-				(gbaInput & KEY_R) ? "R " : "",
-				(gbaInput & KEY_UP) ? "UP " : "",
-				(gbaInput & KEY_DOWN) ? "DOWN " : "",
-				(gbaInput & KEY_LEFT) ? "LEFT " : "",
-				(gbaInput & KEY_RIGHT) ? "RIGHT" : "");
+				textMoveTo(5, 0);
+				textPuts("                          ");
+				textMoveTo(5, 0);
+				if (gbaInput & KEY_A) textPuts("A ");
+				if (gbaInput & KEY_B) textPuts("B ");
+				if (gbaInput & KEY_START) textPuts("STA ");
+				if (gbaInput & KEY_SELECT) textPuts("SEL ");
+				if (gbaInput & KEY_L) textPuts("L ");
+				if (gbaInput & KEY_R) textPuts("R ");
+				if (gbaInput & KEY_UP) textPuts("UP ");
+				if (gbaInput & KEY_DOWN) textPuts("DOWN ");
+				if (gbaInput & KEY_LEFT) textPuts("LEFT ");
+				if (gbaInput & KEY_RIGHT) textPuts("RIGHT");
 			}
+			// Forced blank stops the LCD controller from fetching VRAM
+			if (bDisplayOff && (gbaInput & KEYS_DISPLAY_WAKE) == KEYS_DISPLAY_WAKE &&
+			    (previousGbaInput & KEYS_DISPLAY_WAKE) != KEYS_DISPLAY_WAKE)
+				REG_DISPCNT ^= LCDC_OFF;
 			previousGbaInput = gbaInput;
 		}
 	}
+	if (nReplayMode == REPLAY_RECORD)
+		replaySave();
 	RegisterRamReset(RESET_ALL_REG);
 	main();
 }
@@ -0,0 +1,683 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <gba_input.h>
+#include <gba_video.h>
+#include "bios.h"
+#include "bootprof.h"
+#include "latency.h"
+#include "main.h"
+#include "prof.h"
+#include "si.h"
+#include "text.h"
+
+// Setup and UI code, linked in EWRAM so that IWRAM stays free for the
+// Joybus loop and its tables. Nothing here runs while polled.
+
+static const char aGameProfilesNames[7][30] = {
+	"Custom profile",
+	"Default",
+	"Super Smash Ultimate",
+	"Mario Kart Double Dash",
+	"Mario Kart 8 Deluxe",
+	"New Super Mario Bros",
+	"Mario Kart Wii"
+};
+
+static const int aDefaultProfileConfig[CUSTOM_CONFIG] = {
+	ID_GCPAD_A, ID_GCPAD_B, ID_GCPAD_START, ID_GCPAD_Z, ID_GCPAD_L, ID_GCPAD_R,
+	MACRO_SHORT_HOP,
+	// SHIFT held: the recalibration chord on START, the D-pad on L and R
+	ID_GCPAD_X, ID_GCPAD_Y, ID_GCPAD_RECAL, ID_GCPAD_Z, ID_GCPAD_LEFT, ID_GCPAD_RIGHT,
+	ID_GCPAD_UP, ID_GCPAD_DOWN
+};
+
+// Values of the shift layer rows, in the order LEFT/RIGHT go through them
+static const int aShiftTargets[] = {
+	ID_GCPAD_A, ID_GCPAD_B, ID_GCPAD_X, ID_GCPAD_Y, ID_GCPAD_START, ID_GCPAD_Z, ID_GCPAD_L, ID_GCPAD_R,
+	ID_GCPAD_UP, ID_GCPAD_DOWN, ID_GCPAD_LEFT, ID_GCPAD_RIGHT, ID_GCPAD_RECAL, ID_GCPAD_NONE
+};
+#define SHIFT_TARGETS ((int)(sizeof(aShiftTargets) / sizeof(*aShiftTargets)))
+
+static const char* rumbleType EWRAM_BSS;
+
+#define EZFLASHOMEGADE_FlashBase_S71		(void*)0x08000000
+#define EZFLASHOMEGADE_SET_info_offset 0x7B0000
+#define EZFLASHOMEGADE_assress_led_open_sel 16
+#define EZFLASHOMEGADE_assress_saveMODE 64
+
+static inline u16 IWRAM_CODE EZFLASHOMEGADE_Read_SET_info(u32 offset)
+{
+	return *((vu16 *)(EZFLASHOMEGADE_FlashBase_S71+EZFLASHOMEGADE_SET_info_offset+offset*2));
+}
+
+static inline void EZFLASHOMEGADE_SetROMPage( const u16 _page ) {
+  *( vu16 * )0x9fe0000 = 0xd200;
+  *( vu16 * )0x8000000 = 0x1500;
+  *( vu16 * )0x8020000 = 0xd200;
+  *( vu16 * )0x8040000 = 0x1500;
+  *( vu16 * )0x9880000 = _page;
+  *( vu16 * )0x9fc0000 = 0x1500;
+}
+
+static bool isEzFlashOmegaDefinitiveEdition() {
+	EZFLASHOMEGADE_SetROMPage( 0x8002 ); // Change to kernel mode
+	u16 ledOpenOption = EZFLASHOMEGADE_Read_SET_info(EZFLASHOMEGADE_assress_led_open_sel);
+	u16 norSaveMode = EZFLASHOMEGADE_Read_SET_info(EZFLASHOMEGADE_assress_saveMODE); // Prevent detection of non definitive edition omegas...
+	bool isEzFlashOmegaDefinitiveEdition = (ledOpenOption == 0 || ledOpenOption == 1) && norSaveMode != 65535;
+	EZFLASHOMEGADE_SetROMPage( 0x200 ); // Return to original mode
+	return isEzFlashOmegaDefinitiveEdition;
+}
+
+bool has_motor(void)
+{
+	switch (ROM[0x59]) {
+		case 0x59:
+			switch (ROM[0xFFFFFF]) {
+				case ~0x0002:
+					rumbleType = "NDS";
+					rumble = RUMBLE_NDS;
+					return true;
+				case ~0x0101:
+					rumbleType = "NDS SLIDE";
+					rumble = RUMBLE_NDS_SLIDE;
+					return true;
+			}
+			break;
+		case 0x96:
+			switch (ROM[0x56] & 0xFF) {
+				case 'R':
+				case 'V':
+					rumbleType = "GBA";
+					rumble = RUMBLE_GBA;
+					return true;
+			}
+			break;
+	}
+	if (isEzFlashOmegaDefinitiveEdition()) {
+		rumbleType = "EZFlash Omega DE";
+		rumble = RUMBLE_EZFLASH_OMEGA_DE;
+		return true;
+	}
+	rumbleType = "No";
+	rumble = RUMBLE_NONE;
+	return false;
+}
+
+static const char aGbaKeys[10][7] = {
+	"A",
+	"B",
+	"START",
+	"SELECT",
+	"L",
+	"R",
+	"UP",
+	"DOWN",
+	"LEFT",
+	"RIGHT"
+};
+
+static const char aGcPadButtons[ID_GCPADS][8] = {
+	"A",
+	"B",
+	"X",
+	"Y",
+	"START",
+	"Z",
+	"L",
+	"R",
+	"UP",
+	"DOWN",
+	"LEFT",
+	"RIGHT",
+	"WALK",
+	"TURBO A",
+	"TURBO B",
+	"MACRO",
+	"SHIFT",
+	"X+Y+STA",
+	"NONE",
+};
+
+static const char aShiftChordsNames[SHIFT_CHORDS][7] = {"A+B", "L+R"};
+
+static const char aMacroNames[MACROS][9] = {
+	"ShortHop",
+	"Full hop",
+	"Double A",
+};
+
+void consoleSetup(int phase) {
+	textInit();
+	if (phase == 1) {
+		// Black background
+		BG_COLORS[0] = RGB8(0, 0, 0);
+	} else if (phase == 2) {
+		// Indigo background (same color as a gc controller)
+		BG_COLORS[0] = RGB8(56, 67, 141);
+	}
+	BG_COLORS[241] = RGB5(31, 31, 31); // Text color (white)
+	SetMode(MODE_0 | BG0_ON);
+}
+
+static bool isGameProfileValid(const int* aGameProfileConfig) {
+	bool valid = true;
+	int nGbaKey = 0;
+	while (nGbaKey < 6 && valid) {
+		int nRelatedGcPadButton = aGameProfileConfig[nGbaKey];
+		int i = nGbaKey + 1;
+		while (i < 6 && valid) {
+			if (nRelatedGcPadButton == aGameProfileConfig[i]) {
+				valid = false;
+			} else {
+				i++;
+			}
+		}
+		nGbaKey++;
+	}
+	return valid;
+}
+
+// The builder rows are on two pages, the key mapping with the macro, and
+// the shift layer, the page shown is the one of the cursor
+static void printProfileBuilder(int cursorPosition, const int* aGameProfileConfig) {
+	char selectedCursor[] = " <==";
+	int first = cursorPosition < CUSTOM_SHIFT ? 0 : CUSTOM_SHIFT;
+	int last = cursorPosition < CUSTOM_SHIFT ? CUSTOM_SHIFT : CUSTOM_CONFIG;
+	textClear();
+	if (first == 0) {
+		textPuts("\n=== Game profile builder ===\n\n");
+	} else {
+		textPuts("\n====== SHIFT key held ======\n\n");
+	}
+	textPuts("\n   GBA Keys   |   NGC Pad");
+	textPuts("\n______________|_____________");
+	textPuts("\n              |");
+	for (int i = first; i < last; i++) {
+		textPuts("\n   ");
+		if (i < CUSTOM_MACRO) {
+			textPuts(aGbaKeys[i]);
+		} else if (i == CUSTOM_MACRO) {
+			textPuts("MACRO plays");
+		} else if (i < CUSTOM_CHORDS) {
+			textPuts(aGbaKeys[i - CUSTOM_SHIFT]);
+		} else {
+			textPuts(aShiftChordsNames[i - CUSTOM_CHORDS]);
+		}
+		textMoveTo(7 + i - first, 14);
+		textPuts("|   ");
+		if (i == CUSTOM_MACRO) {
+			textPuts(aMacroNames[aGameProfileConfig[i]]);
+		} else {
+			textPuts(aGcPadButtons[aGameProfileConfig[i]]);
+		}
+		if (i == cursorPosition) {
+			textPuts(selectedCursor);
+		}
+	}
+	textPuts("\n\nUP/DOWN: Navigate");
+	textPuts("\nLEFT/RIGHT: Change mapping");
+	textPuts("\nSELECT: Set default");
+	if (isGameProfileValid(aGameProfileConfig)) {
+		textPuts("\nSTART/A: Validate");
+	} else {
+		textPuts("\nError : invalid game profile");
+	}
+}
+
+// Step a builder row to its next or previous value
+static void stepProfileRow(int* aGameProfileConfig, int row, int step) {
+	int n = aGameProfileConfig[row];
+	if (row < CUSTOM_MACRO) {
+		n = (n + step + ID_GCPAD_SHIFT + 1) % (ID_GCPAD_SHIFT + 1);
+	} else if (row == CUSTOM_MACRO) {
+		n = (n + step + MACROS) % MACROS;
+	} else {
+		int i = 0;
+		while (aShiftTargets[i] != n) {
+			i++;
+		}
+		n = aShiftTargets[(i + step + SHIFT_TARGETS) % SHIFT_TARGETS];
+	}
+	aGameProfileConfig[row] = n;
+}
+
+void showHeader(void) {
+	textClear();
+	textPuts("\n=== GBA AS NGC CONTROLLER ===");
+	textPuts("\nCreated by Extremscorner.org");
+	textPuts("\nModified by Azlino (05-03-21)\n");
+}
+
+int getPressedButtonsNumber(void) {
+	unsigned buttons = ~REG_KEYINPUT;
+	int nPressedButtons = 0;
+	if (buttons & KEY_RIGHT) {
+		nPressedButtons++;
+	} else if (buttons & KEY_LEFT) {
+		nPressedButtons++;
+	}
+	if (buttons & KEY_UP) {
+		nPressedButtons++;
+	} else if (buttons & KEY_DOWN) {
+		nPressedButtons++;
+	}
+	if (buttons & KEY_A) {
+		nPressedButtons++;
+	}
+	if (buttons & KEY_B) {
+		nPressedButtons++;
+	}
+	if (buttons & KEY_L) {
+		nPressedButtons++;
+	}
+	if (buttons & KEY_R) {
+		nPressedButtons++;
+	}
+	if (buttons & KEY_START) {
+		nPressedButtons++;
+	}
+	if (buttons & KEY_SELECT) {
+		nPressedButtons++;
+	}
+	return nPressedButtons;
+}
+
+void inputReleasedWait(void) {
+	while (getPressedButtonsNumber() > 0) {
+		VBlankIntrWait();
+	}
+}
+
+static void printArt() {
+ 	textPuts("\n\n           ___------__");
+	textPuts("\n     |\\__-- /\\       _-");
+	textPuts("\n     |/    __      -");
+	textPuts("\n     //\\  /  \\    /__");
+	textPuts("\n     |  o|  0|__     --_");
+	textPuts("\n     \\\\____-- __ \\   ___-");
+	textPuts("\n     (@@    __/  / /_");
+	textPuts("\n        -_____---   --_\n");
+}
+
+static void configureCustomProfile() {
+	inputReleasedWait();
+	// Entering game profile builder
+	for (int i = 0; i < CUSTOM_CONFIG; i++) {
+		aCustomGameProfileConfig[i] = aDefaultProfileConfig[i];
+	}
+	int cursorPosition = 0;
+	bool validated = false;
+	printProfileBuilder(cursorPosition, aCustomGameProfileConfig);
+	while (!validated) {
+		VBlankIntrWait();
+		bool refreshed = false;
+		unsigned gbaInput = ~REG_KEYINPUT;
+		if ((gbaInput & KEY_START) || (gbaInput & KEY_A)) {
+			// Validate
+			if (isGameProfileValid(aCustomGameProfileConfig)) {
+				validated = true;
+			}
+		} else if (gbaInput & KEY_SELECT) {
+			// Set default mapping
+			for (int i = 0; i < CUSTOM_CONFIG; i++) {
+				aCustomGameProfileConfig[i] = aDefaultProfileConfig[i];
+			}
+			refreshed = true;
+		} else if (gbaInput & KEY_UP) {
+			if (cursorPosition > 0) {
+				cursorPosition--;
+				refreshed = true;
+			}
+		} else if (gbaInput & KEY_DOWN) {
+			if (cursorPosition < CUSTOM_CONFIG - 1) {
+				cursorPosition++;
+				refreshed = true;
+			}
+		} else if (gbaInput & KEY_RIGHT) {
+			stepProfileRow(aCustomGameProfileConfig, cursorPosition, 1);
+			refreshed = true;
+		} else if (gbaInput & KEY_LEFT) {
+			stepProfileRow(aCustomGameProfileConfig, cursorPosition, -1);
+			refreshed = true;
+		}
+		if (refreshed) {
+			printProfileBuilder(cursorPosition, aCustomGameProfileConfig);
+			inputReleasedWait();
+		}
+	}
+}
+
+// Options are kept across soft resets, set to their default on first boot
+int aOptions[OPTIONS] EWRAM_BSS;
+static bool bOptionsSet EWRAM_BSS;
+
+static const char aOffOn[2][5] = {"Off", "On"};
+static const char aReplayModes[3][5] = {"Off", "Rec", "Play"};
+static const char aSensorSticks[3][5] = {"Off", "Main", "C"};
+static const char aReceivers[3][5] = {"Bit", "Spin", "IRQ"};
+static const char aPersonalities[PERSONALITIES][5] = {"Auto", "Pad", "NoRm", "WB", "Cal"};
+static const char aConsoles[2][5] = {"GC", "N64"};
+
+static const struct {
+	char name[16];
+	int min, max, step, def;
+	const char (*labels)[5]; // Printed as a number when NULL, 0 is off
+} aOptionsInfo[OPTIONS] = {
+	[OPTION_PRINT_KEYS]  = {"Print keys", 0, 1, 1, 0, aOffOn},
+	[OPTION_DISPLAY_OFF] = {"Display off", 0, 1, 1, 0, aOffOn},
+	[OPTION_SLEEP]       = {"Sleep after (s)", 0, 60, 5, 0, NULL},
+	[OPTION_TURBO_RATE]  = {"Turbo rate (Hz)", 2, 30, 2, 10, NULL},
+	[OPTION_REPLAY]      = {"Input replay", 0, 2, 1, 0, aReplayModes},
+	[OPTION_SENSOR]      = {"Tilt stick", 0, 2, 1, 0, aSensorSticks},
+	[OPTION_LATCH]       = {"Latch (polls)", 0, 8, 1, 0, NULL},
+	[OPTION_LATENCY]     = {"Latency stats", 0, 1, 1, 0, aOffOn},
+	[OPTION_RECEIVER]    = {"SI receiver", 0, 2, 1, 0, aReceivers},
+	[OPTION_PERSONALITY] = {"Controller", 0, PERSONALITIES - 1, 1, 0, aPersonalities},
+	[OPTION_CONSOLE]     = {"Console", 0, 1, 1, 0, aConsoles},
+};
+
+// Rows of options shown at once, from the first one given. The footer
+// and the print keys warning fill the rest of the 20 rows.
+#define OPTIONS_VISIBLE 7
+
+static void printOptions(int cursorPosition, int first)
+{
+	textClear();
+	textPuts("\n========== Options ==========\n");
+	for (int i = first; i < first + OPTIONS_VISIBLE && i < OPTIONS; i++) {
+		textPuts("\n ");
+		textPuts(aOptionsInfo[i].name);
+		textMoveTo(3 + i - first, 17);
+		if (aOptionsInfo[i].labels) {
+			textPuts(aOptionsInfo[i].labels[aOptions[i]]);
+		} else if (aOptions[i] == 0) {
+			textPuts(aOffOn[0]);
+		} else {
+			textPutInt(aOptions[i]);
+		}
+		if (i == cursorPosition) {
+			textPuts(" <==");
+		}
+	}
+	textMoveTo(3 + OPTIONS_VISIBLE - 1, 0);
+	textPuts("\n\nD-pad: Navigate and change");
+	textPuts("\nSELECT: Statistics");
+	textPuts("\nSTART/A: Validate");
+	textPuts("\n\nDisplay off: L+R+SELECT wakes");
+	textPuts("\nSleep: any key wakes");
+	if (aOptions[OPTION_PRINT_KEYS]) {
+		textPuts("\n\nWarning : print keys reduces\ncompatibility and stability !");
+	}
+}
+
+#ifdef POWER_STATS
+// Cycles to hundredths of seconds
+static int powerCentiSeconds(uint64_t cycles)
+{
+	return (cycles * 100) >> 24;
+}
+#endif
+
+static bool showPowerStats(void)
+{
+	textClear();
+	textPuts("=== Last session power use ==\n");
+#ifdef POWER_STATS
+	uint64_t total = nPowerHaltCycles + nPowerActiveCycles;
+	textPuts("\nHalted (s)");
+	textMoveTo(2, 18);
+	textPutFixed(powerCentiSeconds(nPowerHaltCycles), 2);
+	textPuts("\nActive (s)");
+	textMoveTo(3, 18);
+	textPutFixed(powerCentiSeconds(nPowerActiveCycles), 2);
+	textPuts("\nHalted (%)");
+	textMoveTo(4, 18);
+	textPutFixed(total ? (int)(nPowerHaltCycles * 10000 / total) : 0, 2);
+	textPuts("\nSTOP entries");
+	textMoveTo(5, 18);
+	textPutInt(nPowerStops);
+	textPuts("\n\nTime in STOP is not counted,\ntimers do not run there.");
+#else
+	textPuts("\nNot counted in this build,\nbuild with POWER_STATS=1.");
+#endif
+	return statsPageWait();
+}
+
+bool statsPageWait(void)
+{
+	textMoveTo(TEXT_ROWS - 1, 0);
+	textPuts("A: Next   B: Back");
+	inputReleasedWait();
+	for (;;) {
+		VBlankIntrWait();
+		unsigned buttons = ~REG_KEYINPUT;
+		if ((buttons & KEY_A) || (buttons & KEY_B)) {
+			inputReleasedWait();
+			return buttons & KEY_A;
+		}
+	}
+}
+
+static bool (*const aStatsPages[])(void) = {
+	showBootTimes,
+	showPowerStats,
+	showLatency,
+	showProfile,
+};
+
+static void showStats(void)
+{
+	for (int i = 0; i < sizeof(aStatsPages) / sizeof(*aStatsPages); i++) {
+		if (!aStatsPages[i]())
+			break;
+	}
+}
+
+void configureOptions(void)
+{
+	if (!bOptionsSet) {
+		for (int i = 0; i < OPTIONS; i++) {
+			aOptions[i] = aOptionsInfo[i].def;
+		}
+		bOptionsSet = true;
+	}
+	int cursorPosition = 0;
+	int first = 0;
+	bool validated = false;
+	printOptions(cursorPosition, first);
+	while (!validated) {
+		VBlankIntrWait();
+		bool refreshed = false;
+		unsigned buttons = ~REG_KEYINPUT;
+		if ((buttons & KEY_START) || (buttons & KEY_A)) {
+			validated = true;
+		} else if (buttons & KEY_SELECT) {
+			showStats();
+			refreshed = true;
+		} else if (buttons & KEY_UP) {
+			if (cursorPosition > 0) {
+				cursorPosition--;
+				refreshed = true;
+			}
+		} else if (buttons & KEY_DOWN) {
+			if (cursorPosition < OPTIONS - 1) {
+				cursorPosition++;
+				refreshed = true;
+			}
+		} else if (buttons & KEY_RIGHT) {
+			if (aOptions[cursorPosition] >= aOptionsInfo[cursorPosition].max) {
+				aOptions[cursorPosition] = aOptionsInfo[cursorPosition].min;
+			} else {
+				aOptions[cursorPosition] += aOptionsInfo[cursorPosition].step;
+			}
+			refreshed = true;
+		} else if (buttons & KEY_LEFT) {
+			if (aOptions[cursorPosition] <= aOptionsInfo[cursorPosition].min) {
+				aOptions[cursorPosition] = aOptionsInfo[cursorPosition].max;
+			} else {
+				aOptions[cursorPosition] -= aOptionsInfo[cursorPosition].step;
+			}
+			refreshed = true;
+		}
+		if (refreshed) {
+			// Scroll only when the cursor leaves the visible rows
+			if (cursorPosition < first) {
+				first = cursorPosition;
+			} else if (cursorPosition >= first + OPTIONS_VISIBLE) {
+				first = cursorPosition - OPTIONS_VISIBLE + 1;
+			}
+			printOptions(cursorPosition, first);
+			inputReleasedWait();
+		}
+	}
+	inputReleasedWait();
+}
+
+static void printTimingSelect(int nTiming)
+{
+	showHeader();
+	textPuts("\n======= Joybus config =======\n\n");
+	textPuts("\nCurrent timing : ");
+	textPuts("\n> ");
+	textPutInt(nTiming);
+	textPuts(" (");
+	textPutFixed((nTiming * 5959 + 500) / 1000, 2); // 0.05959 us per cycle
+	textPuts(" microseconds)");
+	textPuts("\n\n\nUP: +1 (slower)");
+	textPuts("\nDOWN: -1 (faster)");
+	textPuts("\n\nSELECT: Set default");
+	textPuts("\nSTART/A: Validate");
+}
+
+int timingSelect(void)
+{
+	int nTiming = 67;
+	bool validated = false;
+	printTimingSelect(nTiming);
+	while (!validated) {
+		VBlankIntrWait();
+		bool refreshed = false;
+		unsigned buttons = ~REG_KEYINPUT;
+		if ((buttons & KEY_START) || (buttons & KEY_A)) {
+			validated = true;
+		} else if (buttons & KEY_SELECT) {
+			nTiming = 67;
+			refreshed = true;
+		} else if (buttons & KEY_UP) {
+			if (nTiming < 100) {
+				nTiming++;
+				refreshed = true;
+			}
+		} else if (buttons & KEY_DOWN) {
+			if (nTiming > 50) {
+				nTiming--;
+				refreshed = true;
+			}
+		}
+		if (refreshed)
+		{
+			printTimingSelect(nTiming);
+			inputReleasedWait();
+		}
+	}
+	nTiming = - nTiming;
+	textPuts("\n\nTimer set to : ");
+	textPutInt(nTiming);
+	inputReleasedWait();
+	return nTiming;
+}
+
+int profileSelect(void) {
+	showHeader();
+	textPuts("\nChoose a game profile :");
+	textPuts("\nSELECT: Make custom profile");
+	textPuts("\nA: ");
+	textPuts(aGameProfilesNames[1]);
+	textPuts("\nB: ");
+	textPuts(aGameProfilesNames[2]);
+	textPuts("\nL: ");
+	textPuts(aGameProfilesNames[3]);
+	textPuts("\nR: ");
+	textPuts(aGameProfilesNames[4]);
+	textPuts("\nUP: ");
+	textPuts(aGameProfilesNames[5]);
+	textPuts("\nRIGHT: ");
+	textPuts(aGameProfilesNames[6]);
+	int nGameProfile = -1;
+	while (nGameProfile == -1) {
+		VBlankIntrWait();
+		unsigned buttons = ~REG_KEYINPUT;
+		if (buttons & KEY_SELECT) {
+			nGameProfile = 0; // Custom
+		} else if (buttons & KEY_A) {
+			nGameProfile = 1; // Default
+		} else if (buttons & KEY_B) {
+			nGameProfile = 2; // Super Smash Ultimate
+		} else if (buttons & KEY_START) {
+			nGameProfile = -1;
+		} else if (buttons & KEY_L) {
+			nGameProfile = 3; // Mario Kart Double Dash
+		} else if (buttons & KEY_R) {
+			nGameProfile = 4; // Mario Kart 8 Deluxe
+		} else if (buttons & KEY_UP) {
+			nGameProfile = 5; // New Super Mario Bros
+		} else if (buttons & KEY_DOWN) {
+			nGameProfile = -1;
+		} else if (buttons & KEY_LEFT) {
+			nGameProfile = -1;
+		} else if (buttons & KEY_RIGHT) {
+			nGameProfile = 6; // Mario Kart Wii
+		}
+	}
+	if (nGameProfile == 0) {
+		configureCustomProfile();
+	}
+	textPuts("\n\nSelected game profile :\n> ");
+	textPuts(aGameProfilesNames[nGameProfile]);
+	inputReleasedWait();
+	return nGameProfile;
+}
+
+const char *gameProfileName(int nGameProfile)
+{
+	return aGameProfilesNames[nGameProfile];
+}
+
+void showControllerScreen(int nGameProfile)
+{
+	consoleSetup(2);
+	showHeader();
+	textPuts("\nGame profile :");
+	textPuts("\n> ");
+	textPuts(aGameProfilesNames[nGameProfile]);
+	textPuts("\nRumble : ");
+	textPuts(rumbleType);
+	printArt();
+	textPuts("\n\nPush A+B+SELECT+START to reset");
+}
@@ -0,0 +1,105 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include "main.h"
+#include "prof.h"
+#include "text.h"
+
+#ifdef PROFILE
+
+static const char aProfSectionsNames[PROF_SECTIONS][10] = {
+	"SI bit",
+	"Mapping",
+	"Reply",
+	"Motor",
+	"Sensor",
+	"SI gap",
+	"SI IRQ",
+	"Turn poll",
+	"Turn cmd",
+};
+
+struct profSection aProfSections[PROF_SECTIONS];
+uint32_t aProfStart[PROF_SECTIONS];
+uint32_t nProfOverhead;
+uint32_t nProfSIWakes, nProfSIBits;
+uint32_t nProfTurnaround;
+
+// Called once the Joybus loop is set up, the results then cover a session
+void profReset(void)
+{
+	nProfOverhead = 0;
+	nProfSIWakes = nProfSIBits = 0;
+	for (int i = 0; i < PROF_SECTIONS; i++) {
+		aProfSections[i] = (struct profSection){ .min = UINT32_MAX };
+	}
+	// Cost of an empty section
+	for (int i = 0; i < 8; i++) {
+		PROF_BEGIN(0);
+		PROF_END(0);
+	}
+	nProfOverhead = aProfSections[0].min;
+	aProfSections[0] = (struct profSection){ .min = UINT32_MAX };
+}
+
+#endif
+
+bool showProfile(void)
+{
+	textClear();
+	textPuts("==== Last session cycles ====\n");
+#ifdef PROFILE
+	textPuts("\nSection   Min   Avg   Max");
+	for (int i = 0; i < PROF_SECTIONS; i++) {
+		const struct profSection *section = &aProfSections[i];
+		textMoveTo(3 + i, 0);
+		textPuts(aProfSectionsNames[i]);
+		if (!section->count) {
+			textMoveTo(3 + i, 10);
+			textPuts("-");
+			continue;
+		}
+		textMoveTo(3 + i, 10);
+		textPutInt(section->min);
+		textMoveTo(3 + i, 16);
+		textPutInt(section->total / section->count);
+		textMoveTo(3 + i, 22);
+		textPutInt(section->max);
+	}
+	textMoveTo(4 + PROF_SECTIONS, 0);
+	textPuts("\nMarker overhead removed: ");
+	textPutInt(nProfOverhead);
+	textPuts("\nSI bits per wakeup: ");
+	if (nProfSIWakes)
+		textPutFixed((uint64_t)nProfSIBits * 100 / nProfSIWakes, 2);
+	else
+		textPuts("-");
+#else
+	textPuts("\nNot profiled in this build,\nbuild with PROFILE=1.");
+#endif
+	return statsPageWait();
+}
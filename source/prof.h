@@ -0,0 +1,113 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PROF_H
+#define PROF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "clock.h"
+
+// Cycle profiling of code sections on the TM2/TM3 counter, built with
+// 'make PROFILE=1'. Otherwise the markers compile to nothing. A section is
+// a PROF_BEGIN/PROF_END pair; a begin without an end is simply dropped.
+// The cost of the markers themselves is measured by profReset() and taken
+// out, but a marker inside SIGetCommand's bit loop still eats into the
+// 4 us per bit budget.
+
+enum {
+	PROF_SI_BIT = 0,
+	PROF_MAPPING,
+	PROF_REPLY,
+	PROF_MOTOR,
+	PROF_SENSOR,
+	PROF_SI_GAP,
+	PROF_SI_IRQ,
+	PROF_TURN_POLL,
+	PROF_TURN_CMD,
+	PROF_SECTIONS
+};
+
+#ifdef PROFILE
+
+struct profSection {
+	uint32_t min, max, count;
+	uint64_t total;
+};
+
+extern struct profSection aProfSections[PROF_SECTIONS];
+extern uint32_t aProfStart[PROF_SECTIONS];
+extern uint32_t nProfOverhead;
+
+// Account a measurement taken some other way than a marker pair
+static inline void profSample(int id, uint32_t cycles)
+{
+	struct profSection *section = &aProfSections[id];
+	if (cycles < section->min)
+		section->min = cycles;
+	if (cycles > section->max)
+		section->max = cycles;
+	section->count++;
+	section->total += cycles;
+}
+
+static inline void profEnd(int id, uint32_t t)
+{
+	uint32_t cycles = t - aProfStart[id] - nProfOverhead;
+	if ((int32_t)cycles < 0)
+		cycles = 0;
+	profSample(id, cycles);
+}
+
+#define PROF_BEGIN(id) (aProfStart[id] = clockRead())
+#define PROF_END(id)   profEnd(id, clockRead())
+
+// Cycles from the last bit of a command, as the receiver woke for it or
+// sampled it, to the start of the reply. Taken by SISetResponse, kept in
+// the "Turn poll" section for status polls and "Turn cmd" for the others.
+extern uint32_t nProfTurnaround;
+
+// Halt wakeups of the SI receivers and the bits they returned, idle wakes
+// included, for the bits per wakeup of the selected receiver
+extern uint32_t nProfSIWakes, nProfSIBits;
+
+#define PROF_SI_WAKE()  (nProfSIWakes++)
+#define PROF_SI_BITS(n) (nProfSIBits += (n))
+
+void profReset(void);
+
+#else
+
+#define PROF_BEGIN(id) ((void)0)
+#define PROF_END(id)   ((void)0)
+#define PROF_SI_WAKE()  ((void)0)
+#define PROF_SI_BITS(n) ((void)0)
+
+#endif
+
+bool showProfile(void);
+
+#endif /* PROF_H */
@@ -0,0 +1,115 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <gba_base.h>
+#include "main.h"
+#include "replay.h"
+#include "sensor.h"
+
+// SRAM holds a magic word, the number of entries, then the entries. Only
+// the first 32 KiB are used, the smallest SRAM found on flash carts.
+#define REPLAY_MAGIC      0x50524347 // "GCRP"
+#define REPLAY_SRAM_SIZE  32768
+#define REPLAY_SRAM_MAX   ((REPLAY_SRAM_SIZE - 8) / 2)
+
+uint16_t aReplay[REPLAY_MAX] EWRAM_BSS;
+int nReplayLength EWRAM_BSS;
+int nReplayIndex;
+int nReplayRun;
+
+// SRAM is on an 8-bit bus
+static void sramWrite(int offset, uint32_t value, int size)
+{
+	for (int i = 0; i < size; i++) {
+		((volatile uint8_t *)SRAM)[offset + i] = value >> (i * 8);
+	}
+}
+
+static uint32_t sramRead(int offset, int size)
+{
+	uint32_t value = 0;
+	for (int i = 0; i < size; i++) {
+		value |= (uint32_t)((volatile uint8_t *)SRAM)[offset + i] << (i * 8);
+	}
+	return value;
+}
+
+// The DS rumble pak and the tilt sensor are driven through SRAM accesses
+static bool sramUsable(void)
+{
+	return rumble != RUMBLE_NDS && nSensor != SENSOR_TILT;
+}
+
+static void replayLoad(void)
+{
+	nReplayLength = 0;
+	// Erased SRAM reads 0xFF, so the magic is checked before the length,
+	// and the length is unsigned so that a corrupt one is out of range
+	if (!sramUsable() || sramRead(0, 4) != REPLAY_MAGIC) {
+		return;
+	}
+	uint32_t nLength = sramRead(4, 4);
+	if (nLength > REPLAY_SRAM_MAX) {
+		return;
+	}
+	for (uint32_t i = 0; i < nLength; i++) {
+		aReplay[i] = sramRead(8 + i * 2, 2);
+	}
+	nReplayLength = nLength;
+}
+
+void replaySave(void)
+{
+	if (!sramUsable()) {
+		return;
+	}
+	int nLength = nReplayLength;
+	if (nLength > REPLAY_SRAM_MAX) {
+		nLength = REPLAY_SRAM_MAX;
+	}
+	sramWrite(0, 0, 4); // Invalid until complete
+	for (int i = 0; i < nLength; i++) {
+		sramWrite(8 + i * 2, aReplay[i], 2);
+	}
+	sramWrite(4, nLength, 4);
+	sramWrite(0, REPLAY_MAGIC, 4);
+}
+
+// Called at setup, a recording starts empty and playback uses the last
+// recording still in EWRAM, or the one saved in SRAM. Returns the number
+// of entries to play.
+int replayStart(int mode)
+{
+	nReplayIndex = 0;
+	nReplayRun = 0;
+	if (mode == REPLAY_RECORD) {
+		nReplayLength = 0;
+	} else if (mode == REPLAY_PLAY && nReplayLength == 0) {
+		replayLoad();
+	}
+	return nReplayLength;
+}
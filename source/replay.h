@@ -0,0 +1,82 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <stdint.h>
+
+// GBA keys sampled at each CMD_STATUS, run-length encoded: the 10 key bits
+// and the run length minus one in the top 6 bits, so one entry covers up
+// to 64 polls. Recorded in EWRAM and saved to SRAM.
+
+#define REPLAY_MAX 32768
+#define REPLAY_RUN 0x0400
+
+enum {
+	REPLAY_OFF = 0,
+	REPLAY_RECORD,
+	REPLAY_PLAY
+};
+
+extern uint16_t aReplay[REPLAY_MAX];
+extern int nReplayLength;
+extern int nReplayIndex;
+extern int nReplayRun;
+
+static inline void replayRecord(unsigned keys)
+{
+	keys &= 0x3FF;
+	if (nReplayLength > 0) {
+		unsigned last = aReplay[nReplayLength - 1];
+		if ((last & 0x3FF) == keys && last < 0xFC00) {
+			aReplay[nReplayLength - 1] = last + REPLAY_RUN;
+			return;
+		}
+	}
+	if (nReplayLength < REPLAY_MAX)
+		aReplay[nReplayLength++] = keys;
+}
+
+// Keys of the next CMD_STATUS, -1 past the end of the recording
+static inline int replayNext(void)
+{
+	if (nReplayIndex >= nReplayLength)
+		return -1;
+	unsigned entry = aReplay[nReplayIndex];
+	if (nReplayRun < entry / REPLAY_RUN) {
+		nReplayRun++;
+	} else {
+		nReplayRun = 0;
+		nReplayIndex++;
+	}
+	return entry & 0x3FF;
+}
+
+int replayStart(int mode);
+void replaySave(void);
+
+#endif /* REPLAY_H */
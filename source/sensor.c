@@ -0,0 +1,125 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include "main.h"
+#include "sensor.h"
+
+#define GYRO_LATCH 0x1 // GPIO out, samples the ADC
+#define GYRO_CLOCK 0x2 // GPIO out, next bit on the falling edge
+#define GYRO_DATA  0x4 // GPIO in
+#define GYRO_MOTOR 0x8 // GPIO out, rumble
+
+#define TILT_START1 (*(volatile uint8_t *)0x0E008000)
+#define TILT_START2 (*(volatile uint8_t *)0x0E008100)
+#define TILT_X_LO   (*(volatile uint8_t *)0x0E008200)
+#define TILT_X_HI   (*(volatile uint8_t *)0x0E008300) // Bit 7 set when done
+#define TILT_Y_LO   (*(volatile uint8_t *)0x0E008400)
+#define TILT_Y_HI   (*(volatile uint8_t *)0x0E008500)
+
+int nSensor;
+
+// The first reading is the rest position
+static int nCenterX, nCenterY;
+static bool bCentered;
+static bool bTiltStarted;
+
+static unsigned gyroRead(bool motor)
+{
+	unsigned motorBit = motor ? GYRO_MOTOR : 0;
+	unsigned value = 0;
+	ROM_GPIODIR = GYRO_LATCH | GYRO_CLOCK | GYRO_MOTOR;
+	ROM_GPIODATA = motorBit | GYRO_LATCH | GYRO_CLOCK;
+	ROM_GPIODATA = motorBit | GYRO_CLOCK;
+	for (int i = 0; i < 16; i++) {
+		ROM_GPIODATA = motorBit;
+		value = value << 1 | !!(ROM_GPIODATA & GYRO_DATA);
+		ROM_GPIODATA = motorBit | GYRO_CLOCK;
+	}
+	return value & 0xFFF;
+}
+
+int sensorDetect(void)
+{
+	// Game code of the cartridge header
+	const char *code = (const char *)0x080000AC;
+	bCentered = false;
+	bTiltStarted = false;
+	if (code[0] == 'R' && code[1] == 'Z' && code[2] == 'W') {
+		ROM_GPIOCNT = 1; // GPIO readable
+		nSensor = SENSOR_GYRO;
+	} else if (code[0] == 'K' && (code[1] == 'Y' || code[1] == 'H')) {
+		nSensor = SENSOR_TILT;
+	} else {
+		nSensor = SENSOR_NONE;
+	}
+	return nSensor;
+}
+
+// One step of sampling, called between polls. The gyro is read at once
+// (16 GPIO clocks), the tilt sensor is started on one call and read on a
+// later one. Returns the axes updated, in stick units around 0.
+int sensorSample(bool motor, int *x, int *y)
+{
+	int rawX, rawY = 0;
+	int axes;
+	switch (nSensor) {
+		case SENSOR_GYRO:
+			rawX = gyroRead(motor);
+			axes = SENSOR_X;
+			break;
+		case SENSOR_TILT:
+			if (!bTiltStarted) {
+				TILT_START1 = 0x55;
+				TILT_START2 = 0xAA;
+				bTiltStarted = true;
+				return 0;
+			}
+			if (!(TILT_X_HI & 0x80)) {
+				return 0;
+			}
+			rawX = TILT_X_LO | (TILT_X_HI & 0x0F) << 8;
+			rawY = TILT_Y_LO | (TILT_Y_HI & 0x0F) << 8;
+			bTiltStarted = false;
+			axes = SENSOR_X | SENSOR_Y;
+			break;
+		default:
+			return 0;
+	}
+	if (!bCentered) {
+		nCenterX = rawX;
+		nCenterY = rawY;
+		bCentered = true;
+	}
+	// Full scale is about +-1024 for the gyro and +-224 for the tilt sensor
+	if (nSensor == SENSOR_GYRO) {
+		*x = (rawX - nCenterX) * 25 >> 8;
+	} else {
+		*x = (rawX - nCenterX) * 114 >> 8;
+		*y = (nCenterY - rawY) * 114 >> 8;
+	}
+	return axes;
+}
@@ -0,0 +1,77 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef SI_H
+#define SI_H
+
+#include <stdint.h>
+#include "clock.h"
+
+// Joybus over the link port in GPIO mode, see si.iwram.c
+
+// Timer 1 ticks once a second while waiting for a command
+#define SI_IDLE_RELOAD (-(CLOCK_HZ / 1024))
+
+enum {
+	SI_RECEIVER_BITS = 0, // Samples and shifts each bit as it wakes
+	SI_RECEIVER_SPIN,     // Halts for the first edge, polls the rest
+	SI_RECEIVER_IRQ       // Samples in SIIrq as the halt wakes
+};
+
+// Filled by SIIrq (si_irq.s) on every interrupt taken while receiving
+struct SIIrqLog {
+	uint32_t time;  // Low half of the cycle counter
+	uint32_t level; // REG_RCNT
+	uint32_t irq;   // REG_IF bits acknowledged
+};
+
+extern volatile struct SIIrqLog SIIrqLog;
+
+void SIIrq(void);
+
+void SISetResponse(const void *buf, unsigned bits);
+// Commands end after bits, or earlier at the length given for their
+// first byte when not 0
+int SIGetCommand(void *buf, unsigned bits, const uint8_t lengths[256]);
+int SISleepCommand(void *buf, unsigned bits, const uint8_t lengths[256]);
+int SIGetCommandSpin(void *buf, unsigned bits, const uint8_t lengths[256]);
+int SIGetCommandIrq(void *buf, unsigned bits, const uint8_t lengths[256]);
+#ifdef PROFILE
+unsigned SIIrqLatency(void);
+#endif
+
+#ifdef POWER_STATS
+// Cycles halted waiting for a command and active otherwise, counted by the
+// receiver between powerStart() calls. Timers stop in STOP, so time spent
+// there is not counted and only the entries are.
+extern uint64_t nPowerHaltCycles;
+extern uint64_t nPowerActiveCycles;
+extern unsigned nPowerStops;
+
+void powerStart(void);
+#endif
+
+#endif /* SI_H */
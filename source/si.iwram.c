@@ -24,16 +24,49 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <gba_interrupt.h>
 #include <gba_sio.h>
 #include <gba_timers.h>
 #include "bios.h"
+#include "prof.h"
+#include "si.h"
+
+#include "clock.h"
+
+#ifdef POWER_STATS
+
+uint64_t nPowerHaltCycles;
+uint64_t nPowerActiveCycles;
+unsigned nPowerStops;
+static uint32_t nPowerClock;
+
+void powerStart(void)
+{
+	nPowerHaltCycles = 0;
+	nPowerActiveCycles = 0;
+	nPowerStops = 0;
+	nPowerClock = clockRead();
+}
+
+// Charge the cycles since the last split to a counter
+static inline void powerSplit(uint64_t *counter)
+{
+	uint32_t t = clockRead();
+	*counter += t - nPowerClock;
+	nPowerClock = t;
+}
+#endif
 
 void SISetResponse(const void *buf, unsigned bits)
 {
 	unsigned byte = 0, bit = 0;
 
+#ifdef PROFILE
+	nProfTurnaround = clockRead() - aProfStart[PROF_SI_BIT];
+#endif
+
 	do {
 		if (bit++ % 8 == 0)
 			byte = *(uint8_t *)buf++;
@@ -190,17 +223,30 @@ void SISetResponse(const void *buf, unsigned bits)
 	);
 }
 
-int SIGetCommand(void *buf, unsigned bits)
+// Receive a command, waiting for its first edge in HALT or STOP. Returns
+// 0 when woken without one, by the idle second (timer 1) or a key press.
+static inline int SIReceive(void *buf, unsigned bits, const uint8_t lengths[256], unsigned wait)
 {
 	unsigned byte = 0, bit = 0;
 	unsigned irq;
 
-	REG_TM2CNT_H = REG_TM0CNT_H = 0;
+	REG_TM1CNT_H = REG_TM0CNT_H = 0;
 	REG_IF = irq = REG_IF;
-	REG_TM2CNT_H = TIMER_START | TIMER_IRQ | 3;
+	if (wait == HALT)
+		REG_TM1CNT_H = TIMER_START | TIMER_IRQ | 3;
+
+#ifdef POWER_STATS
+	// Everything since the first edge of the previous command was active
+	powerSplit(&nPowerActiveCycles);
+	if (wait == STOP)
+		nPowerStops++;
+#endif
 
 	do {
-		CustomHalt(irq & IRQ_TIMER2 ? STOP : HALT);
+		CustomHalt(wait);
+		PROF_SI_WAKE();
+		PROF_BEGIN(PROF_SI_BIT);
+		wait = HALT;
 		REG_TM0CNT_H = 0;
 		REG_IF = irq = REG_IF;
 		REG_TM0CNT_H = TIMER_START | TIMER_IRQ;
@@ -209,11 +255,241 @@ int SIGetCommand(void *buf, unsigned bits)
 			byte <<= 1;
 			byte |= !!((REG_RCNT | REG_RCNT | REG_RCNT) & GPIO_SI);
 
-			if (++bit % 8 == 0)
+			if (++bit % 8 == 0) {
 				*(uint8_t *)buf++ = byte;
+				if (bit == 8 && lengths[byte & 0xFF])
+					bits = lengths[byte & 0xFF];
+			}
+
+#ifdef POWER_STATS
+			// Sampled first, the halts between bits count as active
+			if (bit == 1)
+				powerSplit(&nPowerHaltCycles);
+#endif
+			PROF_END(PROF_SI_BIT);
 		} else if (irq & IRQ_TIMER0)
 			break;
+		else {
+			// A key press or the idle second. The keypad interrupt is
+			// level triggered and would wake every halt while the key is
+			// held, it stays masked until main has latched the keys.
+			REG_IE &= ~IRQ_KEYPAD;
+			if (bit == 0) {
+#ifdef POWER_STATS
+				powerSplit(&nPowerHaltCycles);
+#endif
+				break;
+			}
+		}
+	} while (bit < bits);
+
+	PROF_SI_BITS(bit);
+	return bit;
+}
+
+int SIGetCommand(void *buf, unsigned bits, const uint8_t lengths[256])
+{
+	return SIReceive(buf, bits, lengths, HALT);
+}
+
+int SISleepCommand(void *buf, unsigned bits, const uint8_t lengths[256])
+{
+	return SIReceive(buf, bits, lengths, STOP);
+}
+
+// Hybrid receiver: halts for the first edge only, then polls the line so
+// every later bit is sampled, and the stop bit returns, a fixed number of
+// cycles after its falling edge instead of after a halt wakeup.
+#define SI_SAMPLE_CYCLES   33 // 2 us, between the short and the long low
+
+// Wait for the line to rise then fall, false if timer 0 expires first
+static inline bool SISpinEdge(void)
+{
+	while (!(REG_RCNT & GPIO_SI))
+		if (REG_IF & IRQ_TIMER0)
+			return false;
+	while (REG_RCNT & GPIO_SI)
+		if (REG_IF & IRQ_TIMER0)
+			return false;
+	return true;
+}
+
+int SIGetCommandSpin(void *buf, unsigned bits, const uint8_t lengths[256])
+{
+	unsigned byte = 0, bit = 0;
+	unsigned irq, level;
+
+	REG_TM1CNT_H = REG_TM0CNT_H = 0;
+	REG_TM1CNT_L = SI_IDLE_RELOAD;
+	REG_IF = irq = REG_IF;
+	REG_TM1CNT_H = TIMER_START | TIMER_IRQ | 3;
+
+#ifdef POWER_STATS
+	powerSplit(&nPowerActiveCycles);
+#endif
+
+	do {
+		if (bit == 0) {
+			CustomHalt(HALT);
+			PROF_SI_WAKE();
+			REG_IF = irq = REG_IF;
+			if (!(irq & IRQ_SERIAL)) {
+#ifdef POWER_STATS
+				powerSplit(&nPowerHaltCycles);
+#endif
+				break;
+			}
+			REG_TM0CNT_H = 0;
+			REG_TM0CNT_H = TIMER_START | TIMER_IRQ;
+			level = REG_RCNT | REG_RCNT | REG_RCNT;
+#ifdef POWER_STATS
+			powerSplit(&nPowerHaltCycles);
+#endif
+		} else {
+			if (!SISpinEdge())
+				break;
+			uint16_t edge = REG_TM2CNT_L;
+			REG_TM0CNT_H = 0;
+			REG_IF = IRQ_TIMER0;
+			REG_TM0CNT_H = TIMER_START | TIMER_IRQ;
+			while ((uint16_t)(REG_TM2CNT_L - edge) < SI_SAMPLE_CYCLES);
+			level = REG_RCNT;
+		}
+		PROF_BEGIN(PROF_SI_BIT);
+
+		byte = byte << 1 | !!(level & GPIO_SI);
+		if (++bit % 8 == 0) {
+			*(uint8_t *)buf++ = byte;
+			if (bit == 8 && lengths[byte & 0xFF])
+				bits = lengths[byte & 0xFF];
+		}
 	} while (bit < bits);
 
+	PROF_SI_BITS(bit);
 	return bit;
-}
\ No newline at end of file
+}
+
+// Interrupt receiver: the halt wakes into SIIrq through the BIOS
+// dispatcher, which samples and timestamps the line before any C runs.
+// Samples further apart than 1.5 bit periods mean a wake landed outside
+// its bit, so the frame is cut there. PROFILE builds keep the spacing of
+// samples as the "SI gap" section, its spread around the bit period is
+// the jitter of the sample. The latency itself, from the interrupt to the
+// sample, is the "SI IRQ" section, see SIIrqLatency().
+#define SI_IRQ_GAP_MAX     100
+
+volatile struct SIIrqLog SIIrqLog;
+
+// Halt until SIIrq logged an interrupt and return its REG_IF bits. IME is
+// off from the check to the halt, an interrupt taken in between would
+// otherwise leave the halt waiting for the next one. The halt wakes on
+// IE & IF whatever IME is. The interrupt is only taken some cycles after
+// IME is set, so the log is polled for it, and IME is left off again
+// until the next wait.
+static inline unsigned SIIrqWait(void)
+{
+	unsigned irq;
+
+	REG_IME = 0;
+	if (!SIIrqLog.irq) {
+		CustomHalt(HALT);
+		PROF_SI_WAKE();
+	}
+	REG_IME = 1;
+	while (!(irq = SIIrqLog.irq));
+	REG_IME = 0;
+	SIIrqLog.irq = 0;
+	return irq;
+}
+
+int SIGetCommandIrq(void *buf, unsigned bits, const uint8_t lengths[256])
+{
+	unsigned byte = 0, bit = 0;
+	unsigned irq, last = 0;
+	uint16_t nIe = REG_IE;
+
+	REG_TM1CNT_H = REG_TM0CNT_H = 0;
+	REG_TM1CNT_L = SI_IDLE_RELOAD;
+	REG_IF = REG_IF;
+	REG_TM1CNT_H = TIMER_START | TIMER_IRQ | 3;
+
+#ifdef POWER_STATS
+	powerSplit(&nPowerActiveCycles);
+#endif
+
+	SIIrqLog.irq = 0;
+
+	do {
+		// An edge that came while busy is pending and taken right away,
+		// SIIrq restarted timer 0
+		irq = SIIrqWait();
+		PROF_BEGIN(PROF_SI_BIT);
+
+		if (irq & IRQ_SERIAL) {
+			unsigned time = SIIrqLog.time;
+			if (bit > 0) {
+				unsigned gap = (uint16_t)(time - last);
+#ifdef PROFILE
+				profSample(PROF_SI_GAP, gap);
+#endif
+				if (gap > SI_IRQ_GAP_MAX)
+					break;
+			}
+			last = time;
+
+			byte <<= 1;
+			byte |= !!(SIIrqLog.level & GPIO_SI);
+
+			if (++bit % 8 == 0) {
+				*(uint8_t *)buf++ = byte;
+				if (bit == 8 && lengths[byte & 0xFF])
+					bits = lengths[byte & 0xFF];
+			}
+
+#ifdef POWER_STATS
+			if (bit == 1)
+				powerSplit(&nPowerHaltCycles);
+#endif
+		} else if (irq & IRQ_TIMER0)
+			break;
+		else if (bit == 0 && irq) {
+#ifdef POWER_STATS
+			powerSplit(&nPowerHaltCycles);
+#endif
+			break;
+		}
+	} while (bit < bits);
+
+	REG_IE = nIe;
+	PROF_SI_BITS(bit);
+	return bit;
+}
+
+#ifdef PROFILE
+// Cycles from an interrupt to the sample in SIIrq. An SI edge cannot be
+// timestamped, so a timer 0 overflow stands in for it: it wakes the same
+// halt and goes through the same BIOS dispatcher and handler, at a cycle
+// known from the cycle counter. Timer 0 is left stopped. The counter is
+// read one load after the line, and the synchronisation of the GPIO
+// interrupt itself is not covered, so an edge may take a few more cycles.
+#define SI_IRQ_PROBE_CYCLES 256
+
+unsigned SIIrqLatency(void)
+{
+	uint16_t nIe = REG_IE;
+
+	REG_TM0CNT_H = 0;
+	REG_TM0CNT_L = -SI_IRQ_PROBE_CYCLES;
+	REG_IE = IRQ_TIMER0;
+	REG_IF = REG_IF;
+	SIIrqLog.irq = 0;
+
+	uint16_t start = REG_TM2CNT_L;
+	REG_TM0CNT_H = TIMER_START | TIMER_IRQ;
+	SIIrqWait();
+
+	REG_TM0CNT_H = 0;
+	REG_IE = nIe;
+	return (uint16_t)(SIIrqLog.time - start - SI_IRQ_PROBE_CYCLES);
+}
+#endif
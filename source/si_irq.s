@@ -0,0 +1,46 @@
+@
+@ Interrupt entry for SIGetCommandIrq, installed at 0x03007FFC.
+@
+@ The BIOS dispatcher saves r0-r3, r12 and lr, and enters with r0 set to
+@ 0x04000000. Its cycles come before the sample and are part of the
+@ latency SIIrqLatency() measures in PROFILE builds. The line is sampled
+@ before anything else, then the cycle counter. Timer 0 is restarted
+@ right after, so the bit timeout and the reply delay count from a fixed
+@ point past the sample rather than from wherever the receiver resumes.
+@ Then REG_IF is acknowledged and everything logged to SIIrqLog.
+@ The keypad interrupt is level triggered, so it is masked in REG_IE
+@ until the receiver returns and restores it.
+@
+
+	.syntax	unified
+	.section .iwram, "ax", %progbits
+	.arm
+	.align	2
+	.global	SIIrq
+
+SIIrq:
+	add	r12, r0, #0x100
+	ldrh	r2, [r12, #0x34]	@ REG_RCNT
+	ldrh	r1, [r12, #0x08]	@ REG_TM2CNT_L
+	ldrh	r3, [r12, #0x34]
+	orr	r2, r2, r3
+	ldrh	r3, [r12, #0x34]
+	orr	r2, r2, r3
+	mov	r3, #0
+	strh	r3, [r12, #0x02]	@ REG_TM0CNT_H
+	mov	r3, #0xC0		@ TIMER_START | TIMER_IRQ
+	strh	r3, [r12, #0x02]
+
+	add	r12, r12, #0x100
+	ldrh	r3, [r12, #0x02]	@ REG_IF
+	strh	r3, [r12, #0x02]
+	tst	r3, #0x1000		@ IRQ_KEYPAD
+	ldrhne	r0, [r12, #0x00]	@ REG_IE
+	bicne	r0, r0, #0x1000
+	strhne	r0, [r12, #0x00]
+
+	ldr	r0, =SIIrqLog
+	stmia	r0, {r1, r2, r3}
+	bx	lr
+
+	.pool
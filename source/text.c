@@ -0,0 +1,240 @@
+/* 
+ * Copyright (c) 2016-2021, Extrems' Corner.org
+ * All rights reserved.
+ * 
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ * 
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <gba_video.h>
+#include "bios.h"
+#include "text.h"
+
+#define TEXT_CHARBASE 0
+#define TEXT_MAPBASE  4
+#define TEXT_PALETTE  15
+
+#define TEXT_MAP ((uint16_t *)MAP_BASE_ADR(TEXT_MAPBASE))
+
+// Printable ASCII, one byte per row, bit 0 is the leftmost pixel.
+// Unpacked to 4bpp tiles by the BIOS, so each glyph is tile (c - ' ').
+static const uint8_t aFont[96][8] = {
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}, // ' '
+	{0x08, 0x08, 0x08, 0x08, 0x08, 0x00, 0x08, 0x00}, // '!'
+	{0x14, 0x14, 0x14, 0x00, 0x00, 0x00, 0x00, 0x00}, // '"'
+	{0x14, 0x14, 0x3E, 0x14, 0x3E, 0x14, 0x14, 0x00}, // '#'
+	{0x08, 0x3C, 0x0A, 0x1C, 0x28, 0x1E, 0x08, 0x00}, // '$'
+	{0x06, 0x26, 0x10, 0x08, 0x04, 0x32, 0x30, 0x00}, // '%'
+	{0x0C, 0x12, 0x0A, 0x04, 0x2A, 0x12, 0x2C, 0x00}, // '&'
+	{0x08, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00}, // '\''
+	{0x10, 0x08, 0x04, 0x04, 0x04, 0x08, 0x10, 0x00}, // '('
+	{0x04, 0x08, 0x10, 0x10, 0x10, 0x08, 0x04, 0x00}, // ')'
+	{0x00, 0x08, 0x2A, 0x1C, 0x2A, 0x08, 0x00, 0x00}, // '*'
+	{0x00, 0x08, 0x08, 0x3E, 0x08, 0x08, 0x00, 0x00}, // '+'
+	{0x00, 0x00, 0x00, 0x00, 0x0C, 0x08, 0x04, 0x00}, // ','
+	{0x00, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00, 0x00}, // '-'
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C, 0x00}, // '.'
+	{0x00, 0x20, 0x10, 0x08, 0x04, 0x02, 0x00, 0x00}, // '/'
+	{0x1C, 0x22, 0x32, 0x2A, 0x26, 0x22, 0x1C, 0x00}, // '0'
+	{0x08, 0x0C, 0x08, 0x08, 0x08, 0x08, 0x1C, 0x00}, // '1'
+	{0x1C, 0x22, 0x20, 0x10, 0x08, 0x04, 0x3E, 0x00}, // '2'
+	{0x3E, 0x10, 0x08, 0x10, 0x20, 0x22, 0x1C, 0x00}, // '3'
+	{0x10, 0x18, 0x14, 0x12, 0x3E, 0x10, 0x10, 0x00}, // '4'
+	{0x3E, 0x02, 0x1E, 0x20, 0x20, 0x22, 0x1C, 0x00}, // '5'
+	{0x18, 0x04, 0x02, 0x1E, 0x22, 0x22, 0x1C, 0x00}, // '6'
+	{0x3E, 0x20, 0x10, 0x08, 0x04, 0x04, 0x04, 0x00}, // '7'
+	{0x1C, 0x22, 0x22, 0x1C, 0x22, 0x22, 0x1C, 0x00}, // '8'
+	{0x1C, 0x22, 0x22, 0x3C, 0x20, 0x10, 0x0C, 0x00}, // '9'
+	{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00, 0x00}, // ':'
+	{0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x08, 0x04, 0x00}, // ';'
+	{0x10, 0x08, 0x04, 0x02, 0x04, 0x08, 0x10, 0x00}, // '<'
+	{0x00, 0x00, 0x3E, 0x00, 0x3E, 0x00, 0x00, 0x00}, // '='
+	{0x04, 0x08, 0x10, 0x20, 0x10, 0x08, 0x04, 0x00}, // '>'
+	{0x1C, 0x22, 0x20, 0x10, 0x08, 0x00, 0x08, 0x00}, // '?'
+	{0x1C, 0x22, 0x20, 0x2C, 0x2A, 0x2A, 0x1C, 0x00}, // '@'
+	{0x1C, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x00}, // 'A'
+	{0x1E, 0x22, 0x22, 0x1E, 0x22, 0x22, 0x1E, 0x00}, // 'B'
+	{0x1C, 0x22, 0x02, 0x02, 0x02, 0x22, 0x1C, 0x00}, // 'C'
+	{0x0E, 0x12, 0x22, 0x22, 0x22, 0x12, 0x0E, 0x00}, // 'D'
+	{0x3E, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x3E, 0x00}, // 'E'
+	{0x3E, 0x02, 0x02, 0x1E, 0x02, 0x02, 0x02, 0x00}, // 'F'
+	{0x1C, 0x22, 0x02, 0x3A, 0x22, 0x22, 0x3C, 0x00}, // 'G'
+	{0x22, 0x22, 0x22, 0x3E, 0x22, 0x22, 0x22, 0x00}, // 'H'
+	{0x1C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C, 0x00}, // 'I'
+	{0x38, 0x10, 0x10, 0x10, 0x10, 0x12, 0x0C, 0x00}, // 'J'
+	{0x22, 0x12, 0x0A, 0x06, 0x0A, 0x12, 0x22, 0x00}, // 'K'
+	{0x02, 0x02, 0x02, 0x02, 0x02, 0x02, 0x3E, 0x00}, // 'L'
+	{0x22, 0x36, 0x2A, 0x2A, 0x22, 0x22, 0x22, 0x00}, // 'M'
+	{0x22, 0x22, 0x26, 0x2A, 0x32, 0x22, 0x22, 0x00}, // 'N'
+	{0x1C, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00}, // 'O'
+	{0x1E, 0x22, 0x22, 0x1E, 0x02, 0x02, 0x02, 0x00}, // 'P'
+	{0x1C, 0x22, 0x22, 0x22, 0x2A, 0x12, 0x2C, 0x00}, // 'Q'
+	{0x1E, 0x22, 0x22, 0x1E, 0x0A, 0x12, 0x22, 0x00}, // 'R'
+	{0x3C, 0x02, 0x02, 0x1C, 0x20, 0x20, 0x1E, 0x00}, // 'S'
+	{0x3E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00}, // 'T'
+	{0x22, 0x22, 0x22, 0x22, 0x22, 0x22, 0x1C, 0x00}, // 'U'
+	{0x22, 0x22, 0x22, 0x22, 0x22, 0x14, 0x08, 0x00}, // 'V'
+	{0x22, 0x22, 0x22, 0x2A, 0x2A, 0x2A, 0x14, 0x00}, // 'W'
+	{0x22, 0x22, 0x14, 0x08, 0x14, 0x22, 0x22, 0x00}, // 'X'
+	{0x22, 0x22, 0x22, 0x14, 0x08, 0x08, 0x08, 0x00}, // 'Y'
+	{0x3E, 0x20, 0x10, 0x08, 0x04, 0x02, 0x3E, 0x00}, // 'Z'
+	{0x1C, 0x04, 0x04, 0x04, 0x04, 0x04, 0x1C, 0x00}, // '['
+	{0x00, 0x02, 0x04, 0x08, 0x10, 0x20, 0x00, 0x00}, // backslash
+	{0x1C, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1C, 0x00}, // ']'
+	{0x08, 0x14, 0x22, 0x00, 0x00, 0x00, 0x00, 0x00}, // '^'
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x3E}, // '_'
+	{0x04, 0x08, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00}, // '`'
+	{0x00, 0x00, 0x1C, 0x20, 0x3C, 0x22, 0x3C, 0x00}, // 'a'
+	{0x02, 0x02, 0x1A, 0x26, 0x22, 0x22, 0x1E, 0x00}, // 'b'
+	{0x00, 0x00, 0x1C, 0x02, 0x02, 0x22, 0x1C, 0x00}, // 'c'
+	{0x20, 0x20, 0x2C, 0x32, 0x22, 0x22, 0x3C, 0x00}, // 'd'
+	{0x00, 0x00, 0x1C, 0x22, 0x3E, 0x02, 0x1C, 0x00}, // 'e'
+	{0x18, 0x24, 0x04, 0x0E, 0x04, 0x04, 0x04, 0x00}, // 'f'
+	{0x00, 0x00, 0x3C, 0x22, 0x22, 0x3C, 0x20, 0x1C}, // 'g'
+	{0x02, 0x02, 0x1A, 0x26, 0x22, 0x22, 0x22, 0x00}, // 'h'
+	{0x08, 0x00, 0x0C, 0x08, 0x08, 0x08, 0x1C, 0x00}, // 'i'
+	{0x10, 0x00, 0x18, 0x10, 0x10, 0x10, 0x12, 0x0C}, // 'j'
+	{0x02, 0x02, 0x12, 0x0A, 0x06, 0x0A, 0x12, 0x00}, // 'k'
+	{0x0C, 0x08, 0x08, 0x08, 0x08, 0x08, 0x1C, 0x00}, // 'l'
+	{0x00, 0x00, 0x16, 0x2A, 0x2A, 0x22, 0x22, 0x00}, // 'm'
+	{0x00, 0x00, 0x1A, 0x26, 0x22, 0x22, 0x22, 0x00}, // 'n'
+	{0x00, 0x00, 0x1C, 0x22, 0x22, 0x22, 0x1C, 0x00}, // 'o'
+	{0x00, 0x00, 0x1E, 0x22, 0x22, 0x1E, 0x02, 0x02}, // 'p'
+	{0x00, 0x00, 0x3C, 0x22, 0x22, 0x3C, 0x20, 0x20}, // 'q'
+	{0x00, 0x00, 0x1A, 0x26, 0x02, 0x02, 0x02, 0x00}, // 'r'
+	{0x00, 0x00, 0x1C, 0x02, 0x1C, 0x20, 0x1E, 0x00}, // 's'
+	{0x04, 0x04, 0x0E, 0x04, 0x04, 0x24, 0x18, 0x00}, // 't'
+	{0x00, 0x00, 0x22, 0x22, 0x22, 0x32, 0x2C, 0x00}, // 'u'
+	{0x00, 0x00, 0x22, 0x22, 0x22, 0x14, 0x08, 0x00}, // 'v'
+	{0x00, 0x00, 0x22, 0x22, 0x2A, 0x2A, 0x14, 0x00}, // 'w'
+	{0x00, 0x00, 0x22, 0x14, 0x08, 0x14, 0x22, 0x00}, // 'x'
+	{0x00, 0x00, 0x22, 0x22, 0x22, 0x3C, 0x20, 0x1C}, // 'y'
+	{0x00, 0x00, 0x3E, 0x10, 0x08, 0x04, 0x3E, 0x00}, // 'z'
+	{0x10, 0x08, 0x08, 0x04, 0x08, 0x08, 0x10, 0x00}, // '{'
+	{0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x08, 0x00}, // '|'
+	{0x04, 0x08, 0x08, 0x10, 0x08, 0x08, 0x04, 0x00}, // '}'
+	{0x00, 0x00, 0x04, 0x2A, 0x10, 0x00, 0x00, 0x00}, // '~'
+	{0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00},
+};
+
+static int nTextRow EWRAM_BSS;
+static int nTextCol EWRAM_BSS;
+
+void textInit(void)
+{
+	struct BitUnPack bup = {
+		.size     = sizeof(aFont),
+		.in_bits  = 1,
+		.out_bits = 4,
+	};
+	BitUnPack(aFont, CHAR_BASE_ADR(TEXT_CHARBASE), &bup);
+	REG_BG0CNT  = CHAR_BASE(TEXT_CHARBASE) | SCREEN_BASE(TEXT_MAPBASE) | BG_16_COLOR | BG_SIZE_0;
+	REG_BG0HOFS = 0;
+	REG_BG0VOFS = 0;
+	textClear();
+}
+
+void textClear(void)
+{
+	uint16_t *map = TEXT_MAP;
+	for (int i = 0; i < 32 * 32; i++)
+		map[i] = TEXT_PALETTE << 12;
+	nTextRow = 0;
+	nTextCol = 0;
+}
+
+void textMoveTo(int row, int col)
+{
+	nTextRow = row;
+	nTextCol = col;
+}
+
+static void textNewLine(void)
+{
+	nTextCol = 0;
+	if (++nTextRow < TEXT_ROWS)
+		return;
+
+	uint16_t *map = TEXT_MAP;
+	for (int i = 0; i < (TEXT_ROWS - 1) * 32; i++)
+		map[i] = map[i + 32];
+	for (int i = 0; i < 32; i++)
+		map[(TEXT_ROWS - 1) * 32 + i] = TEXT_PALETTE << 12;
+	nTextRow = TEXT_ROWS - 1;
+}
+
+void textPuts(const char *s)
+{
+	uint16_t *map = TEXT_MAP;
+	for (; *s; s++) {
+		unsigned c = *s;
+		if (c == '\n') {
+			textNewLine();
+			continue;
+		}
+		if (nTextCol >= TEXT_COLS)
+			textNewLine();
+		if (c < ' ' || c > '~')
+			c = '?';
+		map[nTextRow * 32 + nTextCol++] = (c - ' ') | TEXT_PALETTE << 12;
+	}
+}
+
+void textPutInt(int n)
+{
+	char s[12], *p = s + sizeof(s);
+	unsigned u = n < 0 ? -n : n;
+
+	*--p = '\0';
+	do {
+		struct Div d = Div(u, 10);
+		*--p = '0' + d.rem;
+		u = d.quot;
+	} while (u);
+	if (n < 0)
+		*--p = '-';
+	textPuts(p);
+}
+
+// Print n / 10^decimals with all decimals, e.g. (399, 2) prints 3.99
+void textPutFixed(int n, int decimals)
+{
+	char s[12], *p = s + sizeof(s);
+	unsigned u = n < 0 ? -n : n;
+
+	*--p = '\0';
+	for (int i = 0; i < decimals; i++) {
+		struct Div d = Div(u, 10);
+		*--p = '0' + d.rem;
+		u = d.quot;
+	}
+	if (decimals > 0)
+		*--p = '.';
+	do {
+		struct Div d = Div(u, 10);
+		*--p = '0' + d.rem;
+		u = d.quot;
+	} while (u);
+	if (n < 0)
+		*--p = '-';
+	textPuts(p);
+}
@@ -0,0 +1,66 @@
+@
+@ Multiboot stub for the LZ77 compressed controller image.
+@
+@ The BIOS uploads this stub with the compressed payload appended. The
+@ payload is moved to the top of EWRAM, inflated by the BIOS from IWRAM
+@ over the start of EWRAM, and started through its own header like the
+@ BIOS would have. Compressed plus inflated size must fit in 256 KB.
+@
+
+	.section .text
+	.arm
+	.global	_start
+
+_start:
+	b	start
+	.fill	188, 1, 0		@ Header, filled in by gbafix
+
+	b	start			@ 0xC0: normal/multiplay multiboot entry
+boot_info:
+	.byte	0			@ 0xC4: boot method, set by the BIOS
+	.byte	0			@ 0xC5: slave number, set by the BIOS
+	.fill	26, 1, 0
+	b	start			@ 0xE0: Joybus multiboot entry
+
+start:
+	@ Move the payload to the top of EWRAM, last word first
+	ldr	r0, =payload
+	ldr	r1, =payload_end
+	mov	r2, #0x02000000
+	add	r2, r2, #0x00040000
+1:	ldr	r3, [r1, #-4]!
+	str	r3, [r2, #-4]!
+	cmp	r1, r0
+	bhi	1b
+
+	@ Copy the inflater to IWRAM, out of the way of the inflated image
+	ldr	r0, =inflate
+	ldr	r1, =inflate_end
+	mov	r3, #0x03000000
+	mov	r4, r3
+2:	ldr	r5, [r0], #4
+	str	r5, [r3], #4
+	cmp	r0, r1
+	blo	2b
+
+	ldr	r5, =boot_info
+	ldrh	r5, [r5]
+	mov	r0, r2
+	bx	r4
+
+	.ltorg
+
+inflate:
+	mov	r1, #0x02000000
+	swi	0x110000		@ LZ77UnCompWram
+	mov	r0, #0x02000000
+	strh	r5, [r0, #0xC4]		@ Hand the boot info over to the payload
+	add	r0, r0, #0xC0
+	bx	r0
+inflate_end:
+
+	.balign	4
+payload:
+	.incbin	PAYLOAD
+	.balign	4
+payload_end:
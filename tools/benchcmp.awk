@@ -0,0 +1,94 @@
+#
+# Compares benchmark results against the committed baseline.
+#
+# The first file is the baseline, one "metric value tolerance" line per
+# metric. The tolerance is the allowed increase, either in the metric's
+# unit or as a percentage ("64", "5%"). Lower is better, except for
+# metrics whose tolerance starts with "-" ("-5%"): higher is better and
+# the tolerance is the allowed decrease. Every following file holds
+# "metric value" results: the one written by 'make bench' from the linker
+# map, and any taken on hardware from the statistics pages of a PROFILE
+# build, passed with BENCH_RESULTS.
+#
+# Fails when a metric moved past its tolerance. Metrics whose baseline
+# value is still "-" are reported and skipped until 'make bench-baseline'
+# records one, as are baseline metrics without a result, the hardware
+# ones on a build machine.
+#
+# With -v update=FILE the baseline is rewritten to FILE with the measured
+# values, keeping the comments and tolerances, and new metrics appended.
+#
+
+FNR == NR {
+	line[nline++] = $0
+	if (/^#/ || NF == 0)
+		next
+	order[nmetric++] = $1
+	base[$1] = $2
+	tol[$1] = (NF >= 3) ? $3 : "0"
+	next
+}
+
+/^#/ || NF == 0 { next }
+
+{
+	result[$1] = $2
+	if (!($1 in base)) {
+		order[nmetric++] = $1
+		added[$1] = 1
+		base[$1] = "-"
+		tol[$1] = "0"
+	}
+}
+
+function limit(m,    t, higher, l) {
+	t = tol[m]
+	higher = sub(/^-/, "", t)
+	if (t ~ /%$/)
+		l = base[m] * substr(t, 1, length(t) - 1) / 100
+	else
+		l = t + 0
+	return higher ? base[m] - l : base[m] + l
+}
+
+END {
+	status = 0
+	printf "%-28s %10s %10s %8s  %s\n", "METRIC", "BASELINE", "RESULT", "TOL", "STATUS"
+	for (i = 0; i < nmetric; i++) {
+		m = order[i]
+		if (!(m in result)) {
+			printf "%-28s %10s %10s %8s  %s\n", m, base[m], "-", tol[m], "not measured"
+			continue
+		}
+		higher = tol[m] ~ /^-/
+		if (base[m] == "-") {
+			state = "no baseline"
+		} else if (higher ? result[m] + 0 < limit(m) : result[m] + 0 > limit(m)) {
+			state = "REGRESSION"
+			status = 1
+		} else if (higher ? result[m] + 0 > base[m] + 0 : result[m] + 0 < base[m] + 0) {
+			state = "improved"
+		} else {
+			state = "ok"
+		}
+		printf "%-28s %10s %10s %8s  %s\n", m, base[m], result[m], tol[m], state
+	}
+	if (update != "") {
+		for (i = 0; i < nline; i++) {
+			$0 = line[i]
+			if (/^#/ || NF == 0 || !($1 in result))
+				print line[i] > update
+			else
+				print $1, result[$1], tol[$1] > update
+		}
+		for (i = 0; i < nmetric; i++)
+			if (order[i] in added)
+				print order[i], result[order[i]], tol[order[i]] > update
+		if (close(update) != 0) {
+			print "error: cannot write " update
+			exit 1
+		}
+		exit 0
+	}
+	exit status
+}
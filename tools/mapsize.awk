@@ -0,0 +1,139 @@
+#
+# Size report for the linker map emitted by the Makefile (-Wl,-Map).
+#
+# Prints every input section and the global symbols it holds with their
+# size and memory region, the total used in IWRAM and EWRAM, and fails
+# when a budget is exceeded or when a hot-path function did not end up
+# in IWRAM. Static functions are only accounted in their section total.
+#
+# Variables (set with -v):
+#   iwram_budget  maximum bytes of IWRAM used by code and data
+#   ewram_budget  maximum bytes of EWRAM used by code and data
+#   image         size of the multiboot image in bytes
+#   image_budget  maximum size of the multiboot image in bytes
+#   lz_image      size of the compressed multiboot image in bytes
+#   hot           space separated list of functions that must be in IWRAM
+#   out           optional file to write the totals and hot function sizes
+#                 to as "metric value" lines, for tools/benchcmp.awk
+#
+
+function hex(s,    i, n) {
+	s = tolower(s)
+	sub(/^0x/, "", s)
+	n = 0
+	for (i = 1; i <= length(s); i++)
+		n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+	return n
+}
+
+# Address ranges are in decimal, not every awk reads hex constants
+function region(addr) {
+	if (addr >= 50331648 && addr < 67108864)    # 0x03000000-0x03FFFFFF
+		return "IWRAM"
+	if (addr >= 33554432 && addr < 50331648)    # 0x02000000-0x02FFFFFF
+		return "EWRAM"
+	if (addr >= 134217728 && addr < 234881024)  # 0x08000000-0x0DFFFFFF
+		return "ROM"
+	return "-"
+}
+
+function flush(    i, end) {
+	if (secsize > 0)
+		printf "%-6s 0x%08x %6d  %-32s %s\n", region(secaddr), secaddr, secsize, secname, secfile
+	for (i = 0; i < nsym; i++) {
+		end = (i + 1 < nsym) ? symaddr[i + 1] : secaddr + secsize
+		printf "%-6s 0x%08x %6d    %s\n", region(symaddr[i]), symaddr[i], end - symaddr[i], symname[i]
+		where[symname[i]] = region(symaddr[i])
+		symsize[symname[i]] = end - symaddr[i]
+	}
+	secsize = 0
+	nsym = 0
+}
+
+BEGIN {
+	if (iwram_budget == "") iwram_budget = 28672
+	if (ewram_budget == "") ewram_budget = 262144
+	if (image_budget == "") image_budget = 262144
+	nhot = split(hot, hotlist, " ")
+	nsym = 0
+	printf "%-6s %-10s %6s  %-32s %s\n", "REGION", "ADDRESS", "SIZE", "SECTION/SYMBOL", "OBJECT"
+}
+
+/^Linker script and memory map/ { inmap = 1; next }
+!inmap { next }
+
+# Output section: ".name  0xaddr  0xsize"
+/^\.[^ ]+ +0x[0-9a-f]+ +0x[0-9a-f]+/ {
+	flush()
+	size = hex($3)
+	total[region(hex($2))] += size
+	next
+}
+
+# Input section, either on one line or with the address on the next line
+/^ (\.[^ ]+|COMMON)( |$)/ {
+	flush()
+	secname = $1
+	if (NF == 1) {
+		getline
+		$0 = secname " " $0
+	}
+	secaddr = hex($2)
+	secsize = hex($3)
+	secfile = $4
+	sub(/.*\//, "", secfile)
+	next
+}
+
+# Symbol within the current input section
+/^ +0x[0-9a-f]+ +[A-Za-z_][A-Za-z0-9_.]*$/ {
+	addr = hex($1)
+	if (secsize > 0 && addr >= secaddr && addr < secaddr + secsize) {
+		symaddr[nsym] = addr
+		symname[nsym] = $2
+		nsym++
+	}
+	next
+}
+
+END {
+	flush()
+	status = 0
+	printf "\nIWRAM: %6d / %6d bytes\n", total["IWRAM"], iwram_budget
+	printf "EWRAM: %6d / %6d bytes\n", total["EWRAM"], ewram_budget
+	if (image != "")
+		printf "Image: %6d / %6d bytes\n", image, image_budget
+	if (total["IWRAM"] > iwram_budget) {
+		print "error: IWRAM budget exceeded"
+		status = 1
+	}
+	if (total["EWRAM"] > ewram_budget) {
+		print "error: EWRAM budget exceeded"
+		status = 1
+	}
+	if (image != "" && image + 0 > image_budget + 0) {
+		print "error: multiboot image budget exceeded"
+		status = 1
+	}
+	if (out != "") {
+		print "iwram_bytes", total["IWRAM"] + 0 > out
+		print "ewram_bytes", total["EWRAM"] + 0 > out
+		if (image != "")
+			print "image_bytes", image > out
+		if (lz_image != "")
+			print "lz_image_bytes", lz_image > out
+		for (i = 1; i <= nhot; i++)
+			if (hotlist[i] in symsize)
+				print "size_" hotlist[i], symsize[hotlist[i]] > out
+		close(out)
+	}
+	for (i = 1; i <= nhot; i++) {
+		if (!(hotlist[i] in where)) {
+			print "warning: hot function " hotlist[i] " not found"
+		} else if (where[hotlist[i]] != "IWRAM") {
+			print "error: hot function " hotlist[i] " is in " where[hotlist[i]]
+			status = 1
+		}
+	}
+	exit status
+}
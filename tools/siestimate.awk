@@ -0,0 +1,227 @@
+#
+# Static cycle estimate of the edges SISetResponse drives in the linked ELF.
+#
+# Advisory only, not a verification of the waveform: nothing is executed.
+# It reads 'nm' and then 'objdump -d --no-show-raw-insn' output of the ELF
+# and adds up ARM7TDMI cycles along every path through the code with the
+# table below. Each store to REG_RCNT starts a quarter of a Joybus bit,
+# 1 us or about 16.8 cycles, and the interval to the next one is compared
+# with the bounds below. The last interval is reported as the stop bit.
+# The reply delay is timed in main, outside this function, and is not
+# covered.
+#
+# It assumes every strb in the function is a store to REG_RCNT, which
+# holds as long as SISetResponse has no other byte stores, and that the
+# code is ARM. Findings are printed as warnings and never fail the build.
+#
+# Cycle model: data processing 1, +1 with a register shift, +2 writing pc;
+# ldr 3, 5 into pc; str 2; ldm n+2, +2 with pc; stm n+1; mul 4; branch
+# taken 3, not taken 1. Wait states are added per region: none for IWRAM
+# and I/O, 2 per 8/16-bit and 5 per 32-bit access to EWRAM, code fetches
+# included. pc-relative loads are in the code region, sp-relative ones on
+# the IWRAM stack, strb is REG_RCNT, and any other load reads the reply,
+# whose region is the worst one of the reply buffers found by nm.
+#
+# Variables (set with -v):
+#   func       function to estimate, SISetResponse by default
+#   replies    reply buffer symbols, a reply outside IWRAM is reported
+#   qmin       shortest expected interval in cycles, 13 by default
+#   qmax       longest expected interval in cycles, 21 by default
+#
+
+function region(a) {
+	if (a >= hex("3000000") && a < hex("4000000"))
+		return "IWRAM"
+	if (a >= hex("2000000") && a < hex("3000000"))
+		return "EWRAM"
+	return "other"
+}
+
+# Wait states of one access of the given width in bytes
+function waits(r, bytes) {
+	if (r == "EWRAM")
+		return bytes == 4 ? 5 : 2
+	return (r == "IWRAM" || r == "I/O") ? 0 : unknown_waits
+}
+
+function width(m) {
+	return (m ~ /^(ldr|str)s?[bh]/) ? 1 : 4
+}
+
+function cost(i,    m, a, n, r) {
+	m = op[i]
+	a = args[i]
+	if (m ~ /^nop/)
+		return 1 + fetch
+	if (m ~ /^(ldm|pop)/) {
+		n = split(a, regs, ",")
+		r = (m ~ /^pop/ || a ~ /^sp/) ? "IWRAM" : data
+		return n + 2 + n * waits(r, 4) + fetch + (a ~ /pc/ ? 2 + 2 * fetch : 0)
+	}
+	if (m ~ /^(stm|push)/) {
+		n = split(a, regs, ",")
+		r = (m ~ /^push/ || a ~ /^sp/) ? "IWRAM" : data
+		return n + 1 + n * waits(r, 4) + fetch
+	}
+	if (m ~ /^(ldr|str)/) {
+		if (a ~ /\[pc/)
+			r = code
+		else if (a ~ /\[sp/)
+			r = "IWRAM"
+		else if (m ~ /^strb/)
+			r = "I/O"
+		else
+			r = data
+		if (m ~ /^ldr/)
+			return ((a ~ /^pc,/) ? 5 + 2 * fetch : 3) + waits(r, width(m)) + fetch
+		return 2 + waits(r, width(m)) + fetch
+	}
+	if (m ~ /^(mul|mla)/)
+		return 4 + fetch
+	return 1 + (a ~ /(lsl|lsr|asr|ror) r/ ? 1 : 0) + (a ~ /^pc,/ ? 2 + 2 * fetch : 0) + fetch
+}
+
+# Index of the instruction a branch goes to, -1 when leaving the function
+function target(i,    t, off) {
+	t = args[i]
+	if (!match(t, "<" func "\\+0x[0-9a-f]+>"))
+		return (t ~ "<" func ">") ? index_of[start] : -1
+	off = substr(t, RSTART + length(func) + 4, RLENGTH - length(func) - 5)
+	return (start + hex(off)) in index_of ? index_of[start + hex(off)] : -1
+}
+
+function hex(s,    i, n) {
+	s = tolower(s)
+	sub(/^0x/, "", s)
+	n = 0
+	for (i = 1; i <= length(s); i++)
+		n = n * 16 + index("0123456789abcdef", substr(s, i, 1)) - 1
+	return n
+}
+
+# Cycles from instruction i to the next strb, over every path. A path
+# longer than the depth bound is recorded as it stands, a lower bound
+# already past any quarter bit.
+function walk(i, cycles, depth, from,    c, t) {
+	if (i < 0 || i >= n) {
+		if (from >= 0 && !exits[from]++)
+			printf "  strb at 0x%x leaves the function after %d cycles\n", addr[from], cycles
+		return
+	}
+	if (depth > 96 || (op[i] ~ /^strb/ && depth > 0)) {
+		record(from, cycles)
+		return
+	}
+	c = cost(i)
+	if (op[i] ~ /^blx?$/) {
+		printf "warning: call at 0x%x inside %s\n", addr[i], func
+		return
+	}
+	if (op[i] ~ /^bx/) {
+		walk(-1, cycles + 3 + 2 * fetch, depth + 1, from)
+		return
+	}
+	if (op[i] ~ /^b(eq|ne|cs|cc|hs|lo|mi|pl|vs|vc|hi|ls|ge|lt|gt|le)?(\.[nw])?$/) {
+		t = target(i)
+		walk(t, cycles + c + 2 + 2 * fetch, depth + 1, from)
+		if (op[i] !~ /^b(\.[nw])?$/)
+			walk(i + 1, cycles + 1 + fetch, depth + 1, from)
+		return
+	}
+	walk(i + 1, cycles + c, depth + 1, from)
+}
+
+function record(from, cycles) {
+	if (!(from in lo) || cycles < lo[from])
+		lo[from] = cycles
+	if (!(from in hi) || cycles > hi[from])
+		hi[from] = cycles
+}
+
+function check(what, l, h, min, max,    state) {
+	state = (l < min || h > max) ? "OUT OF SPEC" : "ok"
+	printf "  %s %d-%d cycles  %s\n", what, l, h, state
+}
+
+BEGIN {
+	if (func == "") func = "SISetResponse"
+	if (replies == "") replies = "id origin status n64Info n64Status"
+	if (qmin == "") qmin = 13
+	if (qmax == "") qmax = 21
+	unknown_waits = 5
+	nreply = split(replies, reply, " ")
+	n = 0
+}
+
+# nm output: address, type, symbol
+NF == 3 && $1 ~ /^[0-9a-f]+$/ && $2 ~ /^[a-zA-Z]$/ {
+	sym[$3] = hex($1)
+	next
+}
+
+$0 ~ "^ *[0-9a-f]+ <" func ">:" {
+	infunc = 1
+	start = hex($1)
+	next
+}
+
+infunc && NF == 0 { infunc = 0 }
+
+infunc && /^ *[0-9a-f]+:/ {
+	line = $0
+	sub(/^ *[0-9a-f]+:[ \t]+/, "", line)
+	addr[n] = hex(substr($1, 1, length($1) - 1))
+	index_of[addr[n]] = n
+	op[n] = line
+	sub(/[ \t].*/, "", op[n])
+	args[n] = line
+	if (!sub(/^[^ \t]+[ \t]+/, "", args[n]))
+		args[n] = ""
+	sub(/[ \t]*[@;].*/, "", args[n])
+	n++
+}
+
+END {
+	if (!n) {
+		print "warning: " func " not found"
+		exit 0
+	}
+	code = region(start)
+	fetch = waits(code, 4)
+	data = "IWRAM"
+	for (i = 1; i <= nreply; i++) {
+		if (!(reply[i] in sym))
+			continue
+		r = region(sym[reply[i]])
+		if (r != "IWRAM") {
+			printf "warning: reply %s at 0x%x is in %s, not IWRAM\n", reply[i], sym[reply[i]], r
+			if (data != "other")
+				data = r
+		}
+	}
+	printf "%s at 0x%x in %s, replies in %s, quarter bit %d-%d cycles (static estimate, advisory)\n",
+		func, start, code, data, qmin, qmax
+	if (code != "IWRAM") {
+		printf "warning: %s is in %s, not IWRAM\n", func, code
+	}
+
+	last = -1
+	for (i = 0; i < n; i++) {
+		if (op[i] !~ /^strb/)
+			continue
+		walk(i, 0, 0, i)
+		last = i
+		if (!(i in lo))
+			continue
+		check(sprintf("strb at 0x%x: next edge after", addr[i]), lo[i], hi[i], qmin, qmax)
+	}
+	# The stop bit is the last asm block: one low quarter, then the line is
+	# released for good
+	for (i = last - 1; i >= 0 && op[i] !~ /^strb/; i--)
+		;
+	if (i >= 0 && (i in lo))
+		check("stop bit low for", lo[i], hi[i], qmin, qmax)
+	else if (last >= 0)
+		print "warning: no stop bit found"
+	exit 0
+}